@@ -0,0 +1,389 @@
+// 日志性能基准测试（Google Benchmark）
+// 用法: log_benchmark --benchmark_out=results.json --benchmark_out_format=json
+// 日志写入本次运行新建的私有目录 /tmp/log_utils_benchmark.XXXXXX（忽略环境中的 LOG_DIR），结束时删除
+//
+// 单线程用例额外报告逐次调用的延迟分位数（p50_ns / p99_ns / p999_ns / max_ns，已扣除计时本身的开销）
+// 和每条记录写入的字节数（bytes_per_record，日志目录中所有文件的增量）；
+// 多线程用例报告总吞吐量（items_per_second）
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <benchmark/benchmark.h>
+
+#include "log_utils/log_utils.h"
+#include "log_utils/binary_sink.h"
+#include "log_utils/console_sink.h"
+#include "log_utils/json_sink.h"
+#include "log_utils/mapped_sink.h"
+#include "log_utils/sharded_sink.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+char benchmark_dir[] = "/tmp/log_utils_benchmark.XXXXXX";
+
+int removeEntry(const char* path, const struct stat* st, int type, struct FTW* ftw) {
+    (void)st;
+    (void)type;
+    (void)ftw;
+    return ::remove(path);
+}
+
+// 删除本次运行创建的日志目录
+void removeBenchmarkDir() {
+    ::nftw(benchmark_dir, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+log_utils::LogManager& manager() {
+    static bool prepared = [] {
+        if (!::mkdtemp(benchmark_dir)) {
+            std::perror("mkdtemp");
+            std::exit(1);
+        }
+        ::setenv("LOG_DIR", benchmark_dir, 1);
+        // 在 LogManager 构造之前注册，程序退出时在其析构（导出、关闭文件）之后执行
+        std::atexit(removeBenchmarkDir);
+        return true;
+    }();
+    (void)prepared;
+    return log_utils::LogManager::getInstance();
+}
+
+// 日志目录中所有文件的总字节数
+uint64_t logDirectoryBytes() {
+    const std::string& dir = manager().getLogDirectory();
+    uint64_t total = 0;
+    DIR* handle = ::opendir(dir.c_str());
+    if (!handle) {
+        return 0;
+    }
+    while (dirent* entry = ::readdir(handle)) {
+        struct stat st;
+        if (::stat((dir + "/" + entry->d_name).c_str(), &st) == 0 && S_ISREG(st.st_mode)) {
+            total += static_cast<uint64_t>(st.st_size);
+        }
+    }
+    ::closedir(handle);
+    return total;
+}
+
+// 连续两次读取时钟的最小耗时，从每次采样中扣除
+int64_t clockOverhead() {
+    static const int64_t overhead = [] {
+        int64_t best = INT64_MAX;
+        for (int i = 0; i < 10000; ++i) {
+            auto begin = Clock::now();
+            auto end = Clock::now();
+            best = std::min<int64_t>(best, (end - begin).count());
+        }
+        return best;
+    }();
+    return overhead;
+}
+
+// 逐次记录调用耗时并在结束时写入延迟分位数和每条记录的字节数
+class CallRecorder {
+private:
+    benchmark::State& state_;
+    std::vector<int64_t> samples_;
+    uint64_t bytes_before_;
+    int64_t overhead_;
+
+public:
+    explicit CallRecorder(benchmark::State& state)
+        : state_(state), bytes_before_(logDirectoryBytes()), overhead_(clockOverhead()) {
+        samples_.reserve(1 << 20);
+    }
+
+    template<typename Fn>
+    void measure(Fn&& fn) {
+        auto begin = Clock::now();
+        fn();
+        auto end = Clock::now();
+        int64_t ns = (end - begin).count() - overhead_;
+        samples_.push_back(ns > 0 ? ns : 0);
+    }
+
+    ~CallRecorder() {
+        manager().flush();
+        if (samples_.empty()) {
+            return;
+        }
+        std::sort(samples_.begin(), samples_.end());
+        auto percentile = [this](double p) {
+            size_t index = static_cast<size_t>(p * static_cast<double>(samples_.size() - 1));
+            return static_cast<double>(samples_[index]);
+        };
+        state_.counters["p50_ns"] = percentile(0.50);
+        state_.counters["p99_ns"] = percentile(0.99);
+        state_.counters["p999_ns"] = percentile(0.999);
+        state_.counters["max_ns"] = static_cast<double>(samples_.back());
+        state_.counters["bytes_per_record"] =
+            static_cast<double>(logDirectoryBytes() - bytes_before_) / static_cast<double>(samples_.size());
+        state_.SetItemsProcessed(static_cast<int64_t>(samples_.size()));
+    }
+};
+
+// 在用例期间启用异步模式 / 附加输出目标，结束时恢复
+class ScopedAsync {
+public:
+    ScopedAsync() {
+        manager().enableAsync();
+    }
+    ~ScopedAsync() {
+        manager().disableAsync();
+    }
+};
+
+class ScopedGlobalSink {
+private:
+    std::shared_ptr<log_utils::LogSink> sink_;
+
+public:
+    explicit ScopedGlobalSink(std::shared_ptr<log_utils::LogSink> sink) : sink_(std::move(sink)) {
+        manager().addGlobalSink(sink_);
+    }
+    ~ScopedGlobalSink() {
+        manager().flush();
+        manager().removeSink(sink_);
+    }
+};
+
+std::string logPath(const char* name) {
+    return manager().getLogDirectory() + "/" + name;
+}
+
+// ---- 单线程延迟 ----
+
+void BM_Log(benchmark::State& state) {
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG(Bench, INFO, "iteration %d value %f", i, i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_Log);
+
+void BM_LogStream(benchmark::State& state) {
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG_STREAM(Bench, INFO, "iteration " << i << " value " << i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogStream);
+
+void BM_LogKv(benchmark::State& state) {
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG_KV(Bench, INFO, "iteration", "i", i, "value", i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogKv);
+
+// 运行时被过滤掉的 DEBUG 调用
+void BM_LogFilteredDebug(benchmark::State& state) {
+    manager().setMinLevel(log_utils::LogLevel::INFO);
+    {
+        CallRecorder recorder(state);
+        int i = 0;
+        for (auto _ : state) {
+            recorder.measure([&] { LOG(Bench, DEBUG, "iteration %d value %f", i, i * 0.5); });
+            ++i;
+        }
+    }
+    manager().setMinLevel(log_utils::LogLevel::DEBUG);
+}
+BENCHMARK(BM_LogFilteredDebug);
+
+// 被限流拦截的调用（每 100 万次才写一次）
+void BM_LogEveryNSuppressed(benchmark::State& state) {
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG_EVERY_N(Bench, WARN, 1000000, "iteration %d", i); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogEveryNSuppressed);
+
+void BM_LogAsync(benchmark::State& state) {
+    ScopedAsync async;
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG(Bench, INFO, "iteration %d value %f", i, i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogAsync);
+
+void BM_LogStreamAsync(benchmark::State& state) {
+    ScopedAsync async;
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG_STREAM(Bench, INFO, "iteration " << i << " value " << i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogStreamAsync);
+
+void BM_LogKvAsync(benchmark::State& state) {
+    ScopedAsync async;
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG_KV(Bench, INFO, "iteration", "i", i, "value", i * 0.5); });
+        ++i;
+    }
+}
+BENCHMARK(BM_LogKvAsync);
+
+void BM_LogFlightRecorder(benchmark::State& state) {
+    log_utils::FlightRecorderOptions options;
+    options.install_handlers = false;
+    manager().enableFlightRecorder(options);
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG(Bench, INFO, "iteration %d value %f", i, i * 0.5); });
+        ++i;
+    }
+}
+
+// 附加输出目标：除模块日志和汇总日志外再写一份
+template<typename MakeSink>
+void runWithSink(benchmark::State& state, MakeSink&& make_sink, bool async) {
+    ScopedGlobalSink sink(make_sink());
+    std::unique_ptr<ScopedAsync> scoped_async(async ? new ScopedAsync() : nullptr);
+    CallRecorder recorder(state);
+    int i = 0;
+    for (auto _ : state) {
+        recorder.measure([&] { LOG(Bench, INFO, "iteration %d value %f", i, i * 0.5); });
+        ++i;
+    }
+}
+
+void BM_BinarySinkAsync(benchmark::State& state) {
+    runWithSink(state, [] { return std::make_shared<log_utils::BinaryLogSink>(logPath("bench.blog")); }, true);
+}
+BENCHMARK(BM_BinarySinkAsync);
+
+void BM_JsonSink(benchmark::State& state) {
+    runWithSink(state, [] { return std::make_shared<log_utils::JsonLogSink>(logPath("bench.jsonl")); }, false);
+}
+BENCHMARK(BM_JsonSink);
+
+void BM_MappedSink(benchmark::State& state) {
+    runWithSink(state, [] {
+        return std::make_shared<log_utils::MappedFileSink>(logPath("bench_mapped.log"), 16 * 1024 * 1024);
+    }, false);
+}
+BENCHMARK(BM_MappedSink);
+
+// 终端输出（着色）由写线程写出，这里写入 /dev/null，调用线程的开销应与 BM_LogAsync 相同
+void BM_ConsoleSinkAsync(benchmark::State& state) {
+    static const int null_fd = ::open("/dev/null", O_WRONLY | O_CLOEXEC);
+    runWithSink(state, [] {
+        return std::make_shared<log_utils::ConsoleLogSink>(log_utils::LogLevel::INFO,
+                                                           log_utils::ConsoleColor::ALWAYS, null_fd);
+    }, true);
+}
+BENCHMARK(BM_ConsoleSinkAsync);
+
+// ---- 多线程吞吐量 ----
+
+void BM_ThroughputSync(benchmark::State& state) {
+    int i = 0;
+    for (auto _ : state) {
+        LOG(Bench, INFO, "thread %d iteration %d", state.thread_index(), i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ThroughputSync)->ThreadRange(1, 8)->UseRealTime();
+
+void BM_ThroughputAsync(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        manager().enableAsync();
+    }
+    int i = 0;
+    for (auto _ : state) {
+        LOG(Bench, INFO, "thread %d iteration %d", state.thread_index(), i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        manager().disableAsync();
+    }
+}
+BENCHMARK(BM_ThroughputAsync)->ThreadRange(1, 8)->UseRealTime();
+
+// 按 CPU 分片的汇总日志（结束时合并一次，合并时间不计入）
+void BM_ThroughputShardedSummary(benchmark::State& state) {
+    static std::shared_ptr<log_utils::ShardedSummarySink> sharded;
+    if (state.thread_index() == 0) {
+        sharded = log_utils::enableShardedSummary();
+    }
+    int i = 0;
+    for (auto _ : state) {
+        LOG(Bench, INFO, "thread %d iteration %d", state.thread_index(), i++);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        manager().setSummarySink(manager().getSummaryLogger());
+        sharded->merge();
+        sharded.reset();
+    }
+}
+BENCHMARK(BM_ThroughputShardedSummary)->ThreadRange(1, 8)->UseRealTime();
+
+// 按运行时模块名查找已有模块（getLogger / 按模块名写日志的路径），不写日志
+void BM_ModuleLookup(benchmark::State& state) {
+    static const std::vector<std::string> names = [] {
+        std::vector<std::string> result;
+        for (int i = 0; i < 64; ++i) {
+            result.push_back("Lookup" + std::to_string(i));
+            manager().getModule(result.back());
+        }
+        return result;
+    }();
+    size_t i = static_cast<size_t>(state.thread_index());
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(manager().getModule(names[i++ % 64]));
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ModuleLookup)->ThreadRange(1, 8)->UseRealTime();
+
+// 空作用域的计时开销（未启用跟踪，只计入直方图）
+void BM_ScopeTimer(benchmark::State& state) {
+    for (auto _ : state) {
+        LOG_SCOPE_TIMER(Bench, "scope");
+        benchmark::ClobberMemory();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_ScopeTimer)->ThreadRange(1, 8)->UseRealTime();
+
+} // namespace
+
+// 飞行记录器启用后无法关闭，放在最后注册
+BENCHMARK(BM_LogFlightRecorder);
+
+BENCHMARK_MAIN();
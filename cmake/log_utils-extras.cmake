@@ -0,0 +1,12 @@
+# 由 catkin_package(CFG_EXTRAS) 安装，find_package(catkin COMPONENTS log_utils) 时加载
+#
+# log_utils 只有头文件，依赖本包的节点通过 catkin_LIBRARIES 链接头文件中用到的系统库：
+# 异步写线程等后台线程需要 pthread（glibc 2.34 之前 pthread_create 位于 libpthread），
+# 共享内存传输（shm_open / shm_unlink）在 glibc 2.34 之前位于 librt
+set(THREADS_PREFER_PTHREAD_FLAG ON)
+find_package(Threads REQUIRED)
+list(APPEND log_utils_LIBRARIES Threads::Threads)
+
+if(UNIX AND NOT APPLE)
+  list(APPEND log_utils_LIBRARIES rt)
+endif()
@@ -0,0 +1,164 @@
+#ifndef LOG_UTILS_ARG_CAPTURE_H
+#define LOG_UTILS_ARG_CAPTURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+#include "log_utils/format_engine.h"
+
+namespace log_utils {
+
+// 延迟格式化：调用处只保存格式串指针和参数的二进制拷贝，由后台写线程再格式化（见 format_engine.h）
+// 支持算术类型、枚举、指针（按 %p 输出）以及 C 字符串（内容按值拷贝）
+
+// 参数类型代码，随二进制日志保存，离线解码时据此还原参数：
+// b/h/i/l 为 1/2/4/8 字节有符号整数，B/H/I/L 为对应的无符号整数，
+// f/d/D 为 float/double/long double，p 为指针，s 为 C 字符串，? 为无法还原的类型
+template<typename T>
+constexpr char scalarTypeCode() {
+    if constexpr (std::is_enum<T>::value) {
+        return scalarTypeCode<typename std::underlying_type<T>::type>();
+    } else if constexpr (std::is_pointer<T>::value) {
+        return 'p';
+    } else if constexpr (std::is_floating_point<T>::value) {
+        return sizeof(T) == sizeof(float) ? 'f' : (sizeof(T) == sizeof(double) ? 'd' : 'D');
+    } else {
+        constexpr bool is_signed = std::is_signed<T>::value;
+        switch (sizeof(T)) {
+            case 1: return is_signed ? 'b' : 'B';
+            case 2: return is_signed ? 'h' : 'H';
+            case 4: return is_signed ? 'i' : 'I';
+            case 8: return is_signed ? 'l' : 'L';
+            default: return '?';
+        }
+    }
+}
+
+// 按参数类型编码/解码，未支持的类型 kSupported 为 false，调用处会退回立即格式化
+template<typename T, typename Enable = void>
+struct ArgCodec {
+    static constexpr bool kSupported = false;
+};
+
+// 算术类型、枚举和非字符指针：直接按字节拷贝
+template<typename T>
+struct ArgCodec<T, typename std::enable_if<
+        std::is_arithmetic<T>::value || std::is_enum<T>::value ||
+        (std::is_pointer<T>::value &&
+         !std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, char>::value)>::type> {
+    static constexpr bool kSupported = true;
+    static constexpr char kTypeCode = scalarTypeCode<T>();
+    using Decoded = T;
+
+    static size_t size(const T&) {
+        return sizeof(T);
+    }
+
+    static char* encode(char* out, const T& value) {
+        std::memcpy(out, &value, sizeof(T));
+        return out + sizeof(T);
+    }
+
+    static T decode(const char*& in) {
+        T value;
+        std::memcpy(&value, in, sizeof(T));
+        in += sizeof(T);
+        return value;
+    }
+};
+
+// C 字符串：4 字节长度 + 内容 + '\0'，空指针的长度记为 UINT32_MAX
+template<typename T>
+struct ArgCodec<T, typename std::enable_if<
+        std::is_pointer<T>::value &&
+        std::is_same<typename std::remove_cv<typename std::remove_pointer<T>::type>::type, char>::value>::type> {
+    static constexpr bool kSupported = true;
+    static constexpr char kTypeCode = 's';
+    using Decoded = const char*;
+
+    static constexpr uint32_t kNullLength = UINT32_MAX;
+
+    static size_t size(const char* value) {
+        return sizeof(uint32_t) + (value ? std::strlen(value) + 1 : 0);
+    }
+
+    static char* encode(char* out, const char* value) {
+        uint32_t length = value ? static_cast<uint32_t>(std::strlen(value)) : kNullLength;
+        std::memcpy(out, &length, sizeof(length));
+        out += sizeof(length);
+        if (value) {
+            std::memcpy(out, value, length + 1);
+            out += length + 1;
+        }
+        return out;
+    }
+
+    static const char* decode(const char*& in) {
+        uint32_t length;
+        std::memcpy(&length, in, sizeof(length));
+        in += sizeof(length);
+        if (length == kNullLength) {
+            return nullptr;
+        }
+        const char* value = in;
+        in += length + 1;
+        return value;
+    }
+};
+
+// 调用处参数到编码类型的映射：先退化数组/函数，再把 char* 统一为 const char*
+template<typename T>
+struct ArgCaptureType {
+    using Decayed = typename std::decay<T>::type;
+    using type = typename std::conditional<std::is_same<Decayed, char*>::value, const char*, Decayed>::type;
+};
+
+// 解码参数并把格式化结果追加到 out
+using DeferredFormatFn = void (*)(const char* format, const char* args, MessageBuffer& out);
+
+// 每组参数类型对应一个静态格式化器，记录中只保存它的指针
+// signature 为各参数的类型代码（见 scalarTypeCode），二进制日志据此离线还原消息
+struct DeferredFormatter {
+    DeferredFormatFn format;
+    const char* signature;
+};
+
+template<typename... Args>
+struct DeferredArgs {
+    static constexpr bool kSupported = (ArgCodec<Args>::kSupported && ...);
+
+    static size_t encodedSize(const Args&... args) {
+        return (ArgCodec<Args>::size(args) + ... + size_t(0));
+    }
+
+    static size_t encode(char* out, const Args&... args) {
+        char* cursor = out;
+        ((cursor = ArgCodec<Args>::encode(cursor, args)), ...);
+        return static_cast<size_t>(cursor - out);
+    }
+
+    static void format(const char* format, const char* args, MessageBuffer& out) {
+        const char* cursor = args;
+        // 花括号初始化保证按参数顺序从左到右解码
+        std::tuple<typename ArgCodec<Args>::Decoded...> values{ArgCodec<Args>::decode(cursor)...};
+        (void)cursor;
+        std::apply([&](const auto&... decoded) {
+            formatTo(out, format, decoded...);
+        }, values);
+    }
+
+    static constexpr char kSignature[] = {ArgCodec<Args>::kTypeCode..., '\0'};
+
+    static const DeferredFormatter* formatter() {
+        static const DeferredFormatter instance{&DeferredArgs::format, kSignature};
+        return &instance;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_ARG_CAPTURE_H
@@ -0,0 +1,302 @@
+#ifndef LOG_UTILS_BATCH_WRITE_H
+#define LOG_UTILS_BATCH_WRITE_H
+
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter) && defined(IORING_FEAT_RW_CUR_POS)
+#define LOG_UTILS_HAVE_IO_URING 1
+#endif
+#endif
+
+// 一次提交多个文件的写入，不依赖 ROS
+//
+// 写线程在一个处理周期内累积各日志文件待写入的数据，周期结束时把所有文件的写入放进 io_uring
+// 的提交队列，一次 io_uring_enter 完成提交和等待，系统调用次数与文件数无关。
+// 内核不支持 io_uring（早于 5.6，或被 seccomp 禁止）时退回为每个文件一次 write。
+// 部分写入或被中断的写入用 write 补齐，写入失败时丢弃该文件本批的数据（与 FileLogger 相同）
+
+namespace log_utils {
+
+// 写满 size 字节，返回实际写入的字节数（出错时小于 size）
+inline size_t writeFully(int fd, const char* data, size_t size) {
+    size_t offset = 0;
+    while (offset < size) {
+        ssize_t n = ::write(fd, data + offset, size - offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        offset += static_cast<size_t>(n);
+    }
+    return offset;
+}
+
+// 一个文件的一次写入；fd 以 O_APPEND 打开，写在文件末尾
+struct BatchWrite {
+    int fd;
+    const char* data;
+    size_t size;
+    size_t written;  // writeAll 返回后为实际写入的字节数
+};
+
+class BatchFileWriter {
+private:
+    static constexpr unsigned kRingEntries = 64;
+    // submitRing 中未取得内核结果的写入：未提交的可以用 write 重做；已提交但结果未知的可能已经写入，
+    // 重做会使数据重复，只能放弃
+    static constexpr int kNotSubmitted = INT_MIN;
+    static constexpr int kResultUnknown = INT_MIN + 1;
+
+#ifdef LOG_UTILS_HAVE_IO_URING
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned* sq_mask_ = nullptr;
+    unsigned* sq_array_ = nullptr;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned* cq_mask_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned entries_ = 0;
+    std::vector<iovec> iovecs_;
+    std::vector<int> results_;
+
+    bool setupRing() {
+        io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, kRingEntries, &params));
+        if (ring_fd_ < 0) {
+            return false;
+        }
+        // 文件偏移为 -1 时使用（O_APPEND 下即为文件末尾的）当前位置，需要 5.6 以上的内核
+        if (!(params.features & IORING_FEAT_RW_CUR_POS)) {
+            return false;
+        }
+        entries_ = params.sq_entries;
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+        sq_ring_ = ::mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            return false;
+        }
+        if (single_mmap) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = ::mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                              ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                cq_ring_ = nullptr;
+                return false;
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqes = ::mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                            ring_fd_, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        sqes_ = static_cast<io_uring_sqe*>(sqes);
+
+        char* sq = static_cast<char*>(sq_ring_);
+        char* cq = static_cast<char*>(cq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        iovecs_.resize(entries_);
+        results_.resize(entries_);
+        return true;
+    }
+
+    // 关闭 ring；之后所有写入都走 write
+    void closeRing() {
+        if (sqes_) {
+            ::munmap(sqes_, sqes_size_);
+            sqes_ = nullptr;
+        }
+        if (cq_ring_ && cq_ring_ != sq_ring_) {
+            ::munmap(cq_ring_, cq_ring_size_);
+        }
+        cq_ring_ = nullptr;
+        if (sq_ring_) {
+            ::munmap(sq_ring_, sq_ring_size_);
+            sq_ring_ = nullptr;
+        }
+        if (ring_fd_ >= 0) {
+            ::close(ring_fd_);
+            ring_fd_ = -1;
+        }
+    }
+
+    // 通过 io_uring 提交 count（不超过 entries_）个写入并等待全部完成，结果写入 results_；
+    // io_uring_enter 出错时关闭 ring，未提交的写入为 kNotSubmitted（由调用方用 write 重做），
+    // 已提交的写入先继续等待结果，仍然无法取得时为 kResultUnknown
+    void submitRing(const BatchWrite* writes, unsigned count) {
+        unsigned tail = *sq_tail_;
+        unsigned mask = *sq_mask_;
+        for (unsigned i = 0; i < count; ++i) {
+            unsigned index = (tail + i) & mask;
+            iovecs_[i].iov_base = const_cast<char*>(writes[i].data);
+            iovecs_[i].iov_len = writes[i].size;
+            io_uring_sqe& sqe = sqes_[index];
+            std::memset(&sqe, 0, sizeof(sqe));
+            sqe.opcode = IORING_OP_WRITEV;
+            sqe.fd = writes[i].fd;
+            sqe.addr = reinterpret_cast<uint64_t>(&iovecs_[i]);
+            sqe.len = 1;
+            sqe.off = static_cast<uint64_t>(-1);
+            sqe.user_data = i;
+            sq_array_[index] = index;
+            results_[i] = kNotSubmitted;
+        }
+        __atomic_store_n(sq_tail_, tail + count, __ATOMIC_RELEASE);
+
+        unsigned to_submit = count;
+        unsigned expected = count;  // 需要等待结果的写入数
+        unsigned completed = 0;
+        bool failed = false;
+        while (completed < expected) {
+            int ret = static_cast<int>(::syscall(__NR_io_uring_enter, ring_fd_, to_submit, expected - completed,
+                                                 IORING_ENTER_GETEVENTS, nullptr, 0));
+            if (ret < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                // 内核按顺序取走提交队列中的请求并推进队头，前 submitted 个已经提交，可能已经写入：
+                // 不再提交剩余的请求，只等待已提交请求的结果
+                unsigned submitted = std::min(__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) - tail, count);
+                if (!failed && submitted > completed) {
+                    failed = true;
+                    to_submit = 0;
+                    expected = submitted;
+                    continue;
+                }
+                for (unsigned i = 0; i < submitted; ++i) {
+                    if (results_[i] == kNotSubmitted) {
+                        results_[i] = kResultUnknown;
+                    }
+                }
+                closeRing();
+                return;
+            }
+            to_submit -= std::min(static_cast<unsigned>(ret), to_submit);
+            unsigned head = *cq_head_;
+            unsigned cq_tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+            while (head != cq_tail) {
+                const io_uring_cqe& cqe = cqes_[head & *cq_mask_];
+                if (cqe.user_data < count) {
+                    results_[cqe.user_data] = cqe.res;
+                    ++completed;
+                }
+                ++head;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+        }
+        if (failed) {
+            // 已提交的请求都已完成，未提交的请求随 ring 一起丢弃，由调用方用 write 重做
+            closeRing();
+        }
+    }
+#endif
+
+public:
+    // 启动时尝试创建 io_uring，失败则只使用 write
+    explicit BatchFileWriter(bool use_io_uring = true) {
+#ifdef LOG_UTILS_HAVE_IO_URING
+        if (use_io_uring && !setupRing()) {
+            closeRing();
+        }
+#else
+        (void)use_io_uring;
+#endif
+    }
+
+    ~BatchFileWriter() {
+#ifdef LOG_UTILS_HAVE_IO_URING
+        closeRing();
+#endif
+    }
+
+    BatchFileWriter(const BatchFileWriter&) = delete;
+    BatchFileWriter& operator=(const BatchFileWriter&) = delete;
+
+    bool usingIoUring() const {
+#ifdef LOG_UTILS_HAVE_IO_URING
+        return ring_fd_ >= 0;
+#else
+        return false;
+#endif
+    }
+
+    // 写出所有请求，返回后每个请求的 written 为实际写入的字节数；同一 fd 的多个请求按顺序写入
+    void writeAll(BatchWrite* writes, size_t count) {
+        size_t done = 0;
+#ifdef LOG_UTILS_HAVE_IO_URING
+        while (ring_fd_ >= 0 && done < count) {
+            // 同一 fd 在一次提交中只出现一次，保证写入顺序
+            unsigned chunk = 0;
+            while (done + chunk < count && chunk < entries_) {
+                bool repeated = false;
+                for (unsigned i = 0; i < chunk; ++i) {
+                    repeated = repeated || writes[done + i].fd == writes[done + chunk].fd;
+                }
+                if (repeated) {
+                    break;
+                }
+                ++chunk;
+            }
+            submitRing(writes + done, chunk);
+            for (unsigned i = 0; i < chunk; ++i) {
+                BatchWrite& write = writes[done + i];
+                int result = results_[i];
+                write.written = result > 0 ? static_cast<size_t>(result) : 0;
+                // 部分写入、被中断或未提交时用 write 补齐；结果未知（可能已经写入）和其他错误
+                // 与 write 出错时相同，放弃本批数据
+                if (write.written < write.size &&
+                    (result >= 0 || result == -EINTR || result == -EAGAIN || result == kNotSubmitted)) {
+                    write.written += writeFully(write.fd, write.data + write.written, write.size - write.written);
+                }
+            }
+            done += chunk;
+        }
+#endif
+        for (; done < count; ++done) {
+            writes[done].written = writeFully(writes[done].fd, writes[done].data, writes[done].size);
+        }
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_BATCH_WRITE_H
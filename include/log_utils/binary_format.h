@@ -0,0 +1,334 @@
+#ifndef LOG_UTILS_BINARY_FORMAT_H
+#define LOG_UTILS_BINARY_FORMAT_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+#include "log_utils/format_engine.h"
+#include "log_utils/log_format.h"
+#include "log_utils/timestamp.h"
+
+// 二进制日志文件格式（BinaryLogSink 写入，log_decode 工具解码），不依赖 ROS
+//
+// 文件由若干段组成，每段以文件头开始：8 字节魔数 + 1 字节时间戳精度。
+// 同一文件被再次打开追加时会写入新的文件头，解码器遇到文件头即重置字典。
+// 文件头之后是一串数据块，每块以 1 字节类型开头：
+//   SITE      编号, 级别(1 字节), 模块名, 文件名, 行号, 格式串（无则为空串）
+//   SIGNATURE 编号, 参数类型代码串（见 scalarTypeCode）
+//   RECORD    时间戳增量(微秒, zigzag), 调用处编号, 参数类型编号, 数据
+//             参数类型编号为 0 时数据是格式化好的消息，否则是调用处参数的原始编码
+// 调用处与参数类型在首次使用前写入，编号在每段内从 1 开始。
+// 整数为 LEB128 变长编码，字符串为 长度 + 内容；参数的原始编码与写入机器的字节序和类型宽度一致，
+// 需要在相同架构上解码
+
+namespace log_utils {
+
+constexpr char kBinaryLogMagic[8] = {'L', 'U', 'B', 'L', 'O', 'G', '0', '1'};
+
+enum class BinaryChunk : uint8_t {
+    SITE = 1,
+    SIGNATURE = 2,
+    RECORD = 3
+};
+
+inline void putVarint(std::string& out, uint64_t value) {
+    while (value >= 0x80) {
+        out += static_cast<char>((value & 0x7f) | 0x80);
+        value >>= 7;
+    }
+    out += static_cast<char>(value);
+}
+
+inline void putSignedVarint(std::string& out, int64_t value) {
+    putVarint(out, (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+}
+
+inline void putString(std::string& out, const char* data, size_t size) {
+    putVarint(out, size);
+    out.append(data, size);
+}
+
+// 写入文件头
+inline void putBinaryHeader(std::string& out, TimestampPrecision precision) {
+    out.append(kBinaryLogMagic, sizeof(kBinaryLogMagic));
+    out += static_cast<char>(precision);
+}
+
+// 带边界检查的顺序读取器，任何一次读取越界后 ok() 为 false
+class BinaryReader {
+private:
+    const char* cursor_;
+    const char* end_;
+    bool ok_;
+
+public:
+    BinaryReader(const char* data, size_t size) : cursor_(data), end_(data + size), ok_(true) {}
+
+    bool ok() const {
+        return ok_;
+    }
+
+    size_t remaining() const {
+        return static_cast<size_t>(end_ - cursor_);
+    }
+
+    // 查看下一个字节但不前进，没有数据时返回 -1
+    int peek() const {
+        return cursor_ < end_ ? static_cast<uint8_t>(*cursor_) : -1;
+    }
+
+    uint8_t readByte() {
+        if (cursor_ >= end_) {
+            ok_ = false;
+            return 0;
+        }
+        return static_cast<uint8_t>(*cursor_++);
+    }
+
+    uint64_t readVarint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = readByte();
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) {
+                return value;
+            }
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    int64_t readSignedVarint() {
+        uint64_t value = readVarint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    // 读取 size 字节，返回指向原始数据的指针
+    const char* readBytes(size_t size) {
+        if (remaining() < size) {
+            ok_ = false;
+            cursor_ = end_;
+            return nullptr;
+        }
+        const char* data = cursor_;
+        cursor_ += size;
+        return data;
+    }
+
+    std::string readString() {
+        size_t size = static_cast<size_t>(readVarint());
+        const char* data = readBytes(size);
+        return data ? std::string(data, size) : std::string();
+    }
+
+    template<typename T>
+    T readValue() {
+        T value{};
+        const char* data = readBytes(sizeof(T));
+        if (data) {
+            std::memcpy(&value, data, sizeof(T));
+        }
+        return value;
+    }
+};
+
+// 按参数类型代码还原调用处的参数原始编码，并按 format 格式化后追加到 out
+// 使用与写线程相同的格式化引擎（format_engine.h），结果与运行时一致。编码损坏时返回 false
+inline bool formatRecordedArgs(std::string& out, const char* format, const char* signature,
+                               const char* args, size_t args_size) {
+    BinaryReader reader(args, args_size);
+    std::vector<FormatArg> values;
+    for (const char* types = signature; *types; ++types) {
+        switch (*types) {
+            case 'b': values.push_back(makeFormatArg(reader.readValue<int8_t>())); break;
+            case 'h': values.push_back(makeFormatArg(reader.readValue<int16_t>())); break;
+            case 'i': values.push_back(makeFormatArg(reader.readValue<int32_t>())); break;
+            case 'l': values.push_back(makeFormatArg(reader.readValue<int64_t>())); break;
+            case 'B': values.push_back(makeFormatArg(reader.readValue<uint8_t>())); break;
+            case 'H': values.push_back(makeFormatArg(reader.readValue<uint16_t>())); break;
+            case 'I': values.push_back(makeFormatArg(reader.readValue<uint32_t>())); break;
+            case 'L': values.push_back(makeFormatArg(reader.readValue<uint64_t>())); break;
+            case 'f': values.push_back(makeFormatArg(reader.readValue<float>())); break;
+            case 'd': values.push_back(makeFormatArg(reader.readValue<double>())); break;
+            case 'D': values.push_back(makeFormatArg(reader.readValue<long double>())); break;
+            case 'p': values.push_back(makeFormatArg(reader.readValue<const void*>())); break;
+            case 's': {
+                uint32_t length = reader.readValue<uint32_t>();
+                const char* value = nullptr;
+                if (length != UINT32_MAX) {
+                    value = reader.readBytes(static_cast<size_t>(length) + 1);
+                    value = value ? value : "";
+                }
+                values.push_back(makeFormatArg(value));
+                break;
+            }
+            default:
+                return false;
+        }
+        if (!reader.ok()) {
+            return false;
+        }
+    }
+
+    InlineMessageBuffer<kLogRecordMessageSize> message;
+    formatArgs(message, format, values.data(), values.size());
+    out.append(message.data(), message.size());
+    return true;
+}
+
+// 二进制日志解码器：把一段完整的文件内容还原为与 FileLogger 完全相同的文本行
+class BinaryLogDecoder {
+private:
+    struct Site {
+        LogLevel level = LogLevel::DEBUG;
+        std::string module;
+        std::string file;
+        int line = 0;
+        std::string format;
+    };
+
+    // 按编号保存已定义的调用处和参数签名；编号是写入进程内的全局编号，可能不连续，
+    // 用哈希表而不是按编号下标的数组，损坏的编号不会导致分配大量内存
+    std::unordered_map<uint64_t, Site> sites_;
+    std::unordered_map<uint64_t, std::string> signatures_;
+    int64_t last_us_ = 0;
+    TimestampPrecision precision_ = TimestampPrecision::MILLISECONDS;
+    TimestampFormatter timestamp_formatter_;
+    std::string message_;
+    std::string line_;
+    std::string error_;
+
+    bool readHeader(BinaryReader& reader) {
+        const char* magic = reader.readBytes(sizeof(kBinaryLogMagic));
+        if (!magic || std::memcmp(magic, kBinaryLogMagic, sizeof(kBinaryLogMagic)) != 0) {
+            error_ = "invalid file header";
+            return false;
+        }
+        uint8_t precision = reader.readByte();
+        if (!reader.ok() || precision > static_cast<uint8_t>(TimestampPrecision::MICROSECONDS)) {
+            error_ = "invalid file header";
+            return false;
+        }
+        precision_ = static_cast<TimestampPrecision>(precision);
+        sites_.clear();
+        signatures_.clear();
+        last_us_ = 0;
+        return true;
+    }
+
+public:
+    // 解码 data 中的全部内容，每还原一行调用一次 on_line(const std::string&)
+    // 遇到损坏或不完整的数据时停止并返回 false，已解码的行不受影响，原因见 error()
+    template<typename OnLine>
+    bool decode(const char* data, size_t size, OnLine&& on_line) {
+        BinaryReader reader(data, size);
+        if (!readHeader(reader)) {
+            return false;
+        }
+
+        while (reader.remaining() > 0) {
+            // 文件被追加写入时会出现新的文件头
+            if (reader.peek() == kBinaryLogMagic[0]) {
+                if (!readHeader(reader)) {
+                    return false;
+                }
+                continue;
+            }
+
+            uint8_t tag = reader.readByte();
+            switch (static_cast<BinaryChunk>(tag)) {
+                case BinaryChunk::SITE: {
+                    uint64_t id = reader.readVarint();
+                    uint8_t level = reader.readByte();
+                    std::string module = reader.readString();
+                    std::string file = reader.readString();
+                    int line = static_cast<int>(reader.readVarint());
+                    std::string format = reader.readString();
+                    if (!reader.ok() || id == 0 || level > static_cast<uint8_t>(LogLevel::ERROR)) {
+                        error_ = "corrupted call site definition";
+                        return false;
+                    }
+                    Site* site = &sites_[id];
+                    site->level = static_cast<LogLevel>(level);
+                    site->module = std::move(module);
+                    site->file = std::move(file);
+                    site->line = line;
+                    site->format = std::move(format);
+                    break;
+                }
+                case BinaryChunk::SIGNATURE: {
+                    uint64_t id = reader.readVarint();
+                    std::string signature = reader.readString();
+                    if (!reader.ok() || id == 0) {
+                        error_ = "corrupted signature definition";
+                        return false;
+                    }
+                    signatures_[id] = std::move(signature);
+                    break;
+                }
+                case BinaryChunk::RECORD: {
+                    int64_t us = last_us_ + reader.readSignedVarint();
+                    uint64_t site_id = reader.readVarint();
+                    uint64_t signature_id = reader.readVarint();
+                    size_t payload_size = static_cast<size_t>(reader.readVarint());
+                    const char* payload = reader.readBytes(payload_size);
+                    if (!reader.ok()) {
+                        error_ = "truncated record";
+                        return false;
+                    }
+                    auto site_it = sites_.find(site_id);
+                    auto signature_it = signatures_.find(signature_id);
+                    if (site_it == sites_.end() || (signature_id != 0 && signature_it == signatures_.end())) {
+                        error_ = "record references an undefined call site or signature";
+                        return false;
+                    }
+                    last_us_ = us;
+                    const Site& site = site_it->second;
+
+                    message_.clear();
+                    if (signature_id == 0) {
+                        message_.append(payload, payload_size);
+                    } else if (!formatRecordedArgs(message_, site.format.c_str(),
+                                                   signature_it->second.c_str(),
+                                                   payload, payload_size)) {
+                        error_ = "corrupted record arguments";
+                        return false;
+                    }
+
+                    char timestamp[kTimestampBufferSize];
+                    timestamp_formatter_.format(
+                        std::chrono::system_clock::time_point(std::chrono::microseconds(us)),
+                        precision_, timestamp);
+                    line_.clear();
+                    renderLine(line_, timestamp, site.level, site.module.c_str(), site.file.c_str(),
+                               site.line, message_.data(), message_.size());
+                    on_line(line_);
+                    break;
+                }
+                default:
+                    error_ = "unknown chunk type";
+                    return false;
+            }
+            if (!reader.ok()) {
+                error_ = "truncated chunk";
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const std::string& error() const {
+        return error_;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_BINARY_FORMAT_H
@@ -0,0 +1,138 @@
+#ifndef LOG_UTILS_BINARY_SINK_H
+#define LOG_UTILS_BINARY_SINK_H
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#include "log_utils/log_utils.h"
+#include "log_utils/binary_format.h"
+
+namespace log_utils {
+
+// 二进制日志输出目标：时间戳只记录增量，级别、模块、文件名和行号按调用处编号引用，
+// 延迟格式化的记录直接保存参数的原始编码，体积远小于文本日志。
+// 格式见 binary_format.h，可用 log_decode 工具还原为文本。文件写入和刷新策略与 FileLogger 相同
+class BinaryLogSink : public LogSink {
+private:
+    using DynamicSiteKey = std::tuple<const char*, const char*, int, int>;
+
+    FileLogger file_;
+    std::mutex mutex_;
+    LogLevel min_level_;
+    std::vector<uint32_t> site_ids_;  // 按 LogCallSite::id 索引的本文件编号，0 表示尚未写入
+    std::map<DynamicSiteKey, uint32_t> dynamic_site_ids_;  // 没有调用处元数据的日志（按模块名写入）
+    std::map<const DeferredFormatter*, uint32_t> signature_ids_;
+    uint32_t next_site_id_;
+    uint32_t next_signature_id_;
+    int64_t last_us_;
+    std::string chunk_;  // 当前记录的编码缓冲区
+
+    void putSite(uint32_t id, const LogEntry& entry, const char* format) {
+        chunk_ += static_cast<char>(BinaryChunk::SITE);
+        putVarint(chunk_, id);
+        chunk_ += static_cast<char>(entry.level);
+        putString(chunk_, entry.module, std::strlen(entry.module));
+        putString(chunk_, entry.file, std::strlen(entry.file));
+        putVarint(chunk_, static_cast<uint64_t>(entry.line));
+        putString(chunk_, format, std::strlen(format));
+    }
+
+    // 返回本文件内的调用处编号，首次出现时先写入定义
+    uint32_t siteId(const LogEntry& entry) {
+        if (entry.site) {
+            uint32_t global_id = entry.site->id;
+            if (site_ids_.size() <= global_id) {
+                site_ids_.resize(global_id + 1, 0);
+            }
+            uint32_t& id = site_ids_[global_id];
+            if (id == 0) {
+                id = ++next_site_id_;
+                putSite(id, entry, entry.site->format ? entry.site->format : "");
+            }
+            return id;
+        }
+
+        DynamicSiteKey key(entry.module, entry.file, entry.line, static_cast<int>(entry.level));
+        auto it = dynamic_site_ids_.find(key);
+        if (it != dynamic_site_ids_.end()) {
+            return it->second;
+        }
+        uint32_t id = ++next_site_id_;
+        dynamic_site_ids_.emplace(key, id);
+        putSite(id, entry, "");
+        return id;
+    }
+
+    uint32_t signatureId(const DeferredFormatter* formatter) {
+        auto it = signature_ids_.find(formatter);
+        if (it != signature_ids_.end()) {
+            return it->second;
+        }
+        uint32_t id = ++next_signature_id_;
+        signature_ids_.emplace(formatter, id);
+        chunk_ += static_cast<char>(BinaryChunk::SIGNATURE);
+        putVarint(chunk_, id);
+        putString(chunk_, formatter->signature, std::strlen(formatter->signature));
+        return id;
+    }
+
+public:
+    BinaryLogSink(const std::string& file_path, LogLevel min_level = LogLevel::DEBUG)
+        : file_(file_path, LogLevel::DEBUG), min_level_(min_level),
+          next_site_id_(0), next_signature_id_(0), last_us_(0) {
+        putBinaryHeader(chunk_, getTimestampPrecision());
+        file_.append(chunk_.data(), chunk_.size(), LogLevel::DEBUG);
+        file_.flush();
+    }
+
+    bool accepts(LogLevel level) const override {
+        return level >= min_level_ && file_.isOpen();
+    }
+
+    void write(const LogEntry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        chunk_.clear();
+        uint32_t site_id = siteId(entry);
+
+        // 只有格式串已记录在调用处定义中的延迟格式化记录才保存原始参数
+        bool raw_args = entry.formatter && entry.site && entry.site->format == entry.format;
+        uint32_t signature_id = raw_args ? signatureId(entry.formatter) : 0;
+
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            entry.timestamp.time_since_epoch()).count();
+        chunk_ += static_cast<char>(BinaryChunk::RECORD);
+        putSignedVarint(chunk_, us - last_us_);
+        last_us_ = us;
+        putVarint(chunk_, site_id);
+        putVarint(chunk_, signature_id);
+        if (raw_args) {
+            putString(chunk_, entry.args, entry.args_size);
+        } else {
+            putString(chunk_, entry.message, entry.message_size);
+        }
+        file_.append(chunk_.data(), chunk_.size(), entry.level);
+    }
+
+    void flush() override {
+        file_.flush();
+    }
+
+    void flushIfDue(std::chrono::steady_clock::time_point now) override {
+        file_.flushIfDue(now);
+    }
+
+    void setFlushOptions(const FlushOptions& options) override {
+        file_.setFlushOptions(options);
+    }
+
+    const std::string& getFilePath() const {
+        return file_.getFilePath();
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_BINARY_SINK_H
@@ -0,0 +1,97 @@
+#ifndef LOG_UTILS_CONSOLE_SINK_H
+#define LOG_UTILS_CONSOLE_SINK_H
+
+#include <cerrno>
+#include <cstdlib>
+#include <mutex>
+#include <string>
+
+#include <unistd.h>
+
+#include "log_utils/log_utils.h"
+#include "log_utils/color_text.hpp"
+
+namespace log_utils {
+
+// 终端着色方式
+enum class ConsoleColor {
+    AUTO = 0,    // 输出为终端且未设置 NO_COLOR 时着色
+    ALWAYS = 1,
+    NEVER = 2
+};
+
+// 终端输出目标：直接写出已渲染的日志行，按级别套上 color_text 的颜色，不经过 iostream 和 rosconsole，
+// 也不再格式化一次。异步模式下由写线程写出，调用线程不访问终端；同步模式下在调用线程内写出。
+// 每条记录一次 write(2)，级别阈值独立于模块日志（默认只显示 INFO 及以上）
+class ConsoleLogSink : public LogSink {
+private:
+    int fd_;
+    LogLevel min_level_;
+    bool color_;
+    std::mutex mutex_;
+    std::string line_;  // 当前记录的着色缓冲区
+
+    // INFO 保持终端默认颜色
+    static const std::string* levelColor(LogLevel level) {
+        switch (level) {
+            case LogLevel::DEBUG:
+                return &color_text::GREEN;
+            case LogLevel::WARN:
+                return &color_text::YELLOW;
+            case LogLevel::ERROR:
+                return &color_text::BOLDRED;
+            default:
+                return nullptr;
+        }
+    }
+
+    void writeFully(const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t written = ::write(fd_, data, size);
+            if (written < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;  // 终端关闭等错误时丢弃，不影响其他输出目标
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+public:
+    explicit ConsoleLogSink(LogLevel min_level = LogLevel::INFO, ConsoleColor color = ConsoleColor::AUTO,
+                            int fd = STDOUT_FILENO)
+        : fd_(fd), min_level_(min_level) {
+        color_ = color == ConsoleColor::ALWAYS ||
+                 (color == ConsoleColor::AUTO && ::isatty(fd) == 1 && !std::getenv("NO_COLOR"));
+    }
+
+    bool accepts(LogLevel level) const override {
+        return level >= min_level_;
+    }
+
+    void write(const LogEntry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        const std::string* color = color_ ? levelColor(entry.level) : nullptr;
+        if (!color) {
+            writeFully(entry.text, entry.text_size);
+            return;
+        }
+        // 颜色在换行之前结束，不影响终端后续的输出
+        size_t size = entry.text_size;
+        if (size > 0 && entry.text[size - 1] == '\n') {
+            --size;
+        }
+        line_.clear();
+        line_.append(*color);
+        line_.append(entry.text, size);
+        line_.append(color_text::RESET);
+        line_ += '\n';
+        writeFully(line_.data(), line_.size());
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_CONSOLE_SINK_H
@@ -0,0 +1,249 @@
+#ifndef LOG_UTILS_FLIGHT_RECORDER_H
+#define LOG_UTILS_FLIGHT_RECORDER_H
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "log_utils/log_format.h"
+#include "log_utils/timestamp.h"
+
+namespace log_utils {
+
+// 飞行记录器配置
+struct FlightRecorderOptions {
+    size_t capacity = 4096;            // 保留最近多少条记录
+    LogLevel level = LogLevel::DEBUG;  // 记录的最低级别，可以低于写入文件的级别
+    bool install_handlers = true;      // 是否在致命信号和 std::terminate 时自动转储
+};
+
+// 飞行记录器：在内存环形缓冲区中保留最近 N 条渲染好的日志行，进程崩溃时转储到文件
+// 记录在调用线程中直接写入（异步模式下也不经过队列），转储只使用异步信号安全的系统调用
+class FlightRecorder {
+public:
+    static constexpr size_t kSlotSize = 512;  // 单条记录的最大长度（含换行），超出部分截断
+
+private:
+    // 槽位按 seqlock 读写：写入前把 sequence 置为 kWriting，写完后置为记录序号 + 1；
+    // 转储时复制内容后再次检查 sequence，期间被改写的记录不输出
+    static constexpr uint64_t kWriting = UINT64_MAX;
+
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};  // 0 为从未写入
+        std::atomic<uint32_t> size{0};
+        char text[kSlotSize];
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t capacity_;
+    LogLevel level_;
+    std::atomic<uint64_t> next_;
+    std::string dump_path_;
+    std::atomic<bool> dumped_;  // 崩溃转储只执行一次（terminate 之后的 SIGABRT 不再重复）
+
+    static inline std::atomic<FlightRecorder*> active_{nullptr};
+    static inline std::atomic<bool> handlers_installed_{false};
+    static inline struct sigaction previous_actions_[NSIG];
+    static inline std::terminate_handler previous_terminate_ = nullptr;
+
+    static constexpr int kFatalSignals[] = {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT, SIGTERM};
+
+    static char* appendBounded(char* out, const char* end, const char* data, size_t size) {
+        size_t n = static_cast<size_t>(end - out) < size ? static_cast<size_t>(end - out) : size;
+        std::memcpy(out, data, n);
+        return out + n;
+    }
+
+    static char* appendString(char* out, const char* end, const char* data) {
+        return appendBounded(out, end, data, std::strlen(data));
+    }
+
+    // 异步信号安全的整数转字符串
+    static char* appendNumber(char* out, const char* end, uint64_t value) {
+        char digits[20];
+        size_t n = 0;
+        do {
+            digits[n++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while (value > 0);
+        while (n > 0 && out < end) {
+            *out++ = digits[--n];
+        }
+        return out;
+    }
+
+    static void writeAll(int fd, const char* data, size_t size) {
+        while (size > 0) {
+            ssize_t n = ::write(fd, data, size);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    static void onSignal(int signal) {
+        FlightRecorder* recorder = active_.load(std::memory_order_acquire);
+        if (recorder) {
+            char reason[32];
+            char* end = appendString(reason, reason + sizeof(reason), "signal ");
+            end = appendNumber(end, reason + sizeof(reason) - 1, static_cast<uint64_t>(signal));
+            *end = '\0';
+            recorder->dumpOnce(reason);
+        }
+        // 恢复之前的处理方式并重新发出信号，保持原有的退出行为（core dump 等）
+        ::sigaction(signal, &previous_actions_[signal], nullptr);
+        ::raise(signal);
+    }
+
+    static void onTerminate() {
+        FlightRecorder* recorder = active_.load(std::memory_order_acquire);
+        if (recorder) {
+            recorder->dumpOnce("std::terminate");
+        }
+        if (previous_terminate_) {
+            previous_terminate_();
+        }
+        std::abort();
+    }
+
+    void dumpOnce(const char* reason) {
+        if (!dumped_.exchange(true)) {
+            dump(reason);
+        }
+    }
+
+public:
+    FlightRecorder(const FlightRecorderOptions& options, const std::string& dump_path)
+        : slots_(new Slot[options.capacity > 0 ? options.capacity : 1]),
+          capacity_(options.capacity > 0 ? options.capacity : 1), level_(options.level),
+          next_(0), dump_path_(dump_path), dumped_(false) {}
+
+    ~FlightRecorder() {
+        FlightRecorder* self = this;
+        active_.compare_exchange_strong(self, nullptr);
+    }
+
+    FlightRecorder(const FlightRecorder&) = delete;
+    FlightRecorder& operator=(const FlightRecorder&) = delete;
+
+    bool accepts(LogLevel level) const {
+        return level >= level_;
+    }
+
+    LogLevel level() const {
+        return level_;
+    }
+
+    const std::string& dumpPath() const {
+        return dump_path_;
+    }
+
+    // 渲染一行并写入环形缓冲区，格式与日志文件相同
+    void record(std::chrono::system_clock::time_point time_point, LogLevel level, const char* module,
+                const char* file, int line, const char* message, size_t message_size) {
+        uint64_t index = next_.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = slots_[index % capacity_];
+        // 另一个线程绕过整个环形缓冲区后仍在写同一槽位时放弃本条，不与其交错写入
+        uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+        if (sequence == kWriting ||
+            !slot.sequence.compare_exchange_strong(sequence, kWriting, std::memory_order_relaxed)) {
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_release);
+
+        char timestamp[kTimestampBufferSize];
+        formatTimestamp(time_point, timestamp);
+        char* out = slot.text;
+        const char* end = slot.text + kSlotSize - 1;  // 预留换行
+        out = appendString(out, end, "[");
+        out = appendString(out, end, timestamp);
+        out = appendString(out, end, "] [");
+        out = appendString(out, end, logLevelName(level));
+        out = appendString(out, end, "] [");
+        out = appendString(out, end, module);
+        out = appendString(out, end, "] ");
+        out = appendString(out, end, file);
+        out = appendString(out, end, ":");
+        out = appendNumber(out, end, static_cast<uint64_t>(line < 0 ? 0 : line));
+        out = appendString(out, end, " - ");
+        out = appendBounded(out, end, message, message_size);
+        *out++ = '\n';
+        slot.size.store(static_cast<uint32_t>(out - slot.text), std::memory_order_relaxed);
+        slot.sequence.store(index + 1, std::memory_order_release);
+    }
+
+    // 把缓冲区中的记录按时间顺序写入 fd（异步信号安全）；其他线程可能仍在写入，
+    // 每条记录先复制到栈上，确认复制期间未被改写后才输出
+    void dumpTo(int fd, const char* reason) const {
+        char header[128];
+        char* out = appendString(header, header + sizeof(header), "==== flight recorder dump (");
+        out = appendString(out, header + sizeof(header) - 8, reason);
+        out = appendString(out, header + sizeof(header), ") ====\n");
+        writeAll(fd, header, static_cast<size_t>(out - header));
+
+        uint64_t next = next_.load(std::memory_order_acquire);
+        uint64_t first = next > capacity_ ? next - capacity_ : 0;
+        char text[kSlotSize];
+        for (uint64_t index = first; index < next; ++index) {
+            const Slot& slot = slots_[index % capacity_];
+            if (slot.sequence.load(std::memory_order_acquire) != index + 1) {
+                continue;
+            }
+            size_t size = slot.size.load(std::memory_order_relaxed);
+            size = size < kSlotSize ? size : kSlotSize;
+            std::memcpy(text, slot.text, size);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.sequence.load(std::memory_order_relaxed) == index + 1) {
+                writeAll(fd, text, size);
+            }
+        }
+    }
+
+    // 转储到 dump_path，覆盖之前的内容（异步信号安全）
+    bool dump(const char* reason) const {
+        int fd = ::open(dump_path_.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return false;
+        }
+        dumpTo(fd, reason);
+        ::fsync(fd);
+        ::close(fd);
+        return true;
+    }
+
+    // 设为崩溃时转储的记录器，并安装致命信号与 std::terminate 处理函数
+    static void installCrashHandlers(FlightRecorder* recorder) {
+        active_.store(recorder, std::memory_order_release);
+        if (handlers_installed_.exchange(true)) {
+            return;
+        }
+        for (int signal : kFatalSignals) {
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = &FlightRecorder::onSignal;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESETHAND;
+            ::sigaction(signal, &action, &previous_actions_[signal]);
+        }
+        previous_terminate_ = std::set_terminate(&FlightRecorder::onTerminate);
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_FLIGHT_RECORDER_H
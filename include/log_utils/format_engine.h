@@ -0,0 +1,556 @@
+#ifndef LOG_UTILS_FORMAT_ENGINE_H
+#define LOG_UTILS_FORMAT_ENGINE_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+
+#include "log_utils/log_format.h"
+
+// 标准库是否提供浮点数的 std::to_chars
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+#define LOG_UTILS_HAVE_FLOAT_TO_CHARS 1
+#endif
+
+// 日志消息的格式化引擎，不依赖 ROS，离线工具（如 log_decode）也使用这里的实现
+//
+// 格式串沿用 printf 语法，但参数按实际类型格式化，不经过 C 可变参数：
+//   - 整数、浮点数用 std::to_chars 转换，常见的无标志、无宽度说明符不调用 snprintf
+//     （浮点数的 std::to_chars 需要 libstdc++ 11 以上，更早的标准库如 Ubuntu 20.04 的 GCC 9
+//     中浮点数仍由 snprintf 转换，输出相同）
+//   - 说明符与参数类型不符时按参数的实际类型输出（如 %d 对应 double 时按 %g 输出），不会产生未定义行为；
+//     长度修饰符（h、l、ll、z 等）被忽略，宽度由参数类型决定
+//   - 参数不足时原样输出多余的说明符，多余的参数被忽略，%n 不写入任何内容
+//   - 消息写入 MessageBuffer，超出初始存储时在堆上扩展，最长 kMaxLogMessageSize 字节
+// 字面量格式串在编译期由编译器的 printf 格式检查（-Wformat）核对，见 LOG_UTILS_CHECK_FORMAT
+
+namespace log_utils {
+
+// 消息缓冲区：先使用调用方提供的存储（线程暂存区、异步队列槽位），不够时扩展到堆上，
+// 长度上限默认为 kMaxLogMessageSize，超出部分丢弃。内容不以 '\0' 结尾
+class MessageBuffer {
+private:
+    char* data_;
+    size_t size_;
+    size_t capacity_;
+    size_t limit_;
+    std::unique_ptr<char[]> heap_;
+
+public:
+    MessageBuffer(char* storage, size_t capacity, size_t limit = kMaxLogMessageSize)
+        : data_(storage), size_(0), capacity_(capacity), limit_(limit) {}
+
+    MessageBuffer(const MessageBuffer&) = delete;
+    MessageBuffer& operator=(const MessageBuffer&) = delete;
+
+    const char* data() const {
+        return data_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    size_t capacity() const {
+        return capacity_;
+    }
+
+    // 清空内容，已扩展的堆存储保留给下一条消息
+    void clear() {
+        size_ = 0;
+    }
+
+    bool onHeap() const {
+        return heap_ != nullptr;
+    }
+
+    // 调整长度上限；不超过当前容量时不再分配内存（实时线程使用）
+    void setLimit(size_t limit) {
+        limit_ = std::min(limit, kMaxLogMessageSize);
+    }
+
+    // 保证末尾至少有 n 字节可写，返回实际可写的字节数（到达上限时可能小于 n）
+    size_t reserve(size_t n) {
+        if (capacity_ - size_ >= n) {
+            return n;
+        }
+        size_t wanted = std::min(std::max(size_ + n, capacity_ * 2), limit_);
+        if (wanted > capacity_) {
+            std::unique_ptr<char[]> grown(new char[wanted]);
+            std::memcpy(grown.get(), data_, size_);
+            heap_ = std::move(grown);
+            data_ = heap_.get();
+            capacity_ = wanted;
+        }
+        return std::min(n, capacity_ - size_);
+    }
+
+    // 末尾的可写位置，配合 reserve / commit 直接在缓冲区内转换
+    char* end() {
+        return data_ + size_;
+    }
+
+    void commit(size_t n) {
+        size_ += n;
+    }
+
+    void append(const char* text, size_t n) {
+        n = reserve(n);
+        std::memcpy(data_ + size_, text, n);
+        size_ += n;
+    }
+
+    void append(size_t count, char ch) {
+        count = reserve(count);
+        std::memset(data_ + size_, ch, count);
+        size_ += count;
+    }
+
+    void push_back(char ch) {
+        if (reserve(1) > 0) {
+            data_[size_++] = ch;
+        }
+    }
+
+    // 交出堆存储（异步记录用它保存超长消息），缓冲区回到传入的初始存储
+    std::unique_ptr<char[]> release(char* storage, size_t capacity) {
+        data_ = storage;
+        size_ = 0;
+        capacity_ = capacity;
+        return std::move(heap_);
+    }
+};
+
+// 带内联存储的消息缓冲区，用作线程暂存区
+template<size_t N>
+class InlineMessageBuffer : public MessageBuffer {
+private:
+    char storage_[N];
+
+public:
+    InlineMessageBuffer() : MessageBuffer(storage_, N) {}
+};
+
+// 类型擦除后的格式化参数，模板只负责把参数转换为这一表示，格式化本身不随参数类型实例化
+struct FormatArg {
+    enum class Type : uint8_t {
+        SIGNED,
+        UNSIGNED,
+        DOUBLE,  // float 按 double 保存，与 printf 的参数提升一致
+        LONG_DOUBLE,
+        STRING,
+        POINTER
+    };
+
+    Type type;
+    uint8_t size;  // 整数的字节数，%u / %x 按该宽度解释负数
+    bool is_char;  // char 类型，说明符不是整数或字符时按字符输出
+    union {
+        long long i;
+        unsigned long long u;
+        double d;
+        const char* s;
+        const void* p;
+    };
+    long double ld;  // 不放入联合体：按值传递含 long double 的联合体在 x86-64 上会触发 -Wpsabi 提示
+};
+
+// 不支持的参数类型（如 std::string、自定义结构体）在编译期报错
+template<typename T>
+struct UnsupportedFormatArg : std::false_type {};
+
+template<typename T>
+inline FormatArg makeFormatArg(const T& value) {
+    using Decayed = typename std::decay<T>::type;
+    FormatArg arg{};
+    if constexpr (std::is_enum<Decayed>::value) {
+        return makeFormatArg(static_cast<typename std::underlying_type<Decayed>::type>(value));
+    } else if constexpr (std::is_same<Decayed, bool>::value) {
+        arg.type = FormatArg::Type::SIGNED;
+        arg.size = sizeof(int);
+        arg.i = value ? 1 : 0;
+    } else if constexpr (std::is_integral<Decayed>::value && std::is_signed<Decayed>::value) {
+        arg.type = FormatArg::Type::SIGNED;
+        arg.size = sizeof(Decayed) < sizeof(int) ? sizeof(int) : sizeof(Decayed);  // 与整数提升一致
+        arg.is_char = std::is_same<Decayed, char>::value;
+        arg.i = static_cast<long long>(value);
+    } else if constexpr (std::is_integral<Decayed>::value) {
+        arg.type = FormatArg::Type::UNSIGNED;
+        arg.size = sizeof(Decayed);
+        arg.is_char = std::is_same<Decayed, char>::value;
+        arg.u = static_cast<unsigned long long>(value);
+    } else if constexpr (std::is_same<Decayed, long double>::value) {
+        arg.type = FormatArg::Type::LONG_DOUBLE;
+        arg.ld = value;
+    } else if constexpr (std::is_floating_point<Decayed>::value) {
+        arg.type = FormatArg::Type::DOUBLE;
+        arg.d = static_cast<double>(value);
+    } else if constexpr (std::is_pointer<Decayed>::value &&
+                         std::is_same<typename std::remove_cv<
+                             typename std::remove_pointer<Decayed>::type>::type, char>::value) {
+        arg.type = FormatArg::Type::STRING;
+        arg.s = value;
+    } else if constexpr (std::is_pointer<Decayed>::value || std::is_same<Decayed, std::nullptr_t>::value) {
+        arg.type = FormatArg::Type::POINTER;
+        arg.p = reinterpret_cast<const void*>(value);
+    } else {
+        static_assert(UnsupportedFormatArg<T>::value,
+                      "LOG arguments must be arithmetic, enum, pointer or C string");
+    }
+    return arg;
+}
+
+// 一个解析后的转换说明
+struct FormatSpec {
+    char flags[8];  // 标志字符，'\0' 结尾
+    int width;      // -1 表示未指定
+    int precision;  // -1 表示未指定
+    char conversion;
+};
+
+inline void appendSigned(MessageBuffer& out, long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+inline void appendUnsigned(MessageBuffer& out, unsigned long long value, int base, bool upper) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, base);
+    size_t n = static_cast<size_t>(result.ptr - digits);
+    if (upper) {
+        for (size_t i = 0; i < n; ++i) {
+            if (digits[i] >= 'a' && digits[i] <= 'f') {
+                digits[i] = static_cast<char>(digits[i] - 'a' + 'A');
+            }
+        }
+    }
+    out.append(digits, n);
+}
+
+// 以 printf 的方式转换一个参数（fast path 不支持的标志、宽度等）；value 已是 printf 期望的类型
+template<typename T>
+inline void appendRawPrintf(MessageBuffer& out, const FormatSpec& spec, const char* length, T value) {
+    char format[48];
+    int n = std::snprintf(format, sizeof(format), "%%%s", spec.flags);
+    if (spec.width >= 0) {
+        n += std::snprintf(format + n, sizeof(format) - n, "%d", spec.width);
+    }
+    if (spec.precision >= 0) {
+        n += std::snprintf(format + n, sizeof(format) - n, ".%d", spec.precision);
+    }
+    std::snprintf(format + n, sizeof(format) - n, "%s%c", length, spec.conversion);
+
+    size_t available = out.reserve(64);
+    int written = std::snprintf(out.end(), available, format, value);
+    if (written < 0) {
+        return;
+    }
+    if (static_cast<size_t>(written) >= available) {
+        available = out.reserve(static_cast<size_t>(written) + 1);
+        written = std::snprintf(out.end(), available, format, value);
+        if (written < 0) {
+            return;
+        }
+    }
+    out.commit(std::min(static_cast<size_t>(written), available > 0 ? available - 1 : 0));
+}
+
+inline bool isPlainSpec(const FormatSpec& spec) {
+    return spec.flags[0] == '\0' && spec.width < 0;
+}
+
+inline void formatInteger(MessageBuffer& out, const FormatSpec& spec, const FormatArg& arg) {
+    char conversion = spec.conversion;
+    // %u / %x / %o 把有符号数按其宽度解释为无符号数，与 printf 相同
+    unsigned long long bits = arg.u;
+    if (arg.type == FormatArg::Type::SIGNED && arg.size < sizeof(unsigned long long)) {
+        bits &= (1ULL << (arg.size * 8)) - 1;
+    }
+    if (conversion == 'c') {
+        char ch = static_cast<char>(arg.i);
+        if (isPlainSpec(spec)) {
+            out.push_back(ch);
+        } else {
+            appendRawPrintf(out, spec, "", static_cast<int>(static_cast<unsigned char>(ch)));
+        }
+        return;
+    }
+    if (conversion == 'd' || conversion == 'i') {
+        if (isPlainSpec(spec) && spec.precision < 0) {
+            if (arg.type == FormatArg::Type::SIGNED) {
+                appendSigned(out, arg.i);
+            } else {
+                appendUnsigned(out, arg.u, 10, false);
+            }
+        } else if (arg.type == FormatArg::Type::SIGNED) {
+            appendRawPrintf(out, spec, "ll", arg.i);
+        } else {
+            FormatSpec adjusted = spec;
+            adjusted.conversion = 'u';
+            appendRawPrintf(out, adjusted, "ll", arg.u);
+        }
+        return;
+    }
+    int base = conversion == 'o' ? 8 : (conversion == 'x' || conversion == 'X' ? 16 : 10);
+    if (isPlainSpec(spec) && spec.precision < 0) {
+        appendUnsigned(out, bits, base, conversion == 'X');
+    } else {
+        appendRawPrintf(out, spec, "ll", bits);
+    }
+}
+
+template<typename Float>
+inline void formatFloating(MessageBuffer& out, const FormatSpec& spec, Float value) {
+#ifndef LOG_UTILS_HAVE_FLOAT_TO_CHARS
+    appendRawPrintf(out, spec, std::is_same<Float, long double>::value ? "L" : "", value);
+#else
+    char conversion = spec.conversion;
+    std::chars_format format;
+    switch (conversion) {
+        case 'f': case 'F': format = std::chars_format::fixed; break;
+        case 'e': case 'E': format = std::chars_format::scientific; break;
+        case 'g': case 'G': format = std::chars_format::general; break;
+        default:
+            appendRawPrintf(out, spec, std::is_same<Float, long double>::value ? "L" : "", value);
+            return;
+    }
+    if (!isPlainSpec(spec)) {
+        appendRawPrintf(out, spec, std::is_same<Float, long double>::value ? "L" : "", value);
+        return;
+    }
+    int precision = spec.precision < 0 ? 6 : spec.precision;
+    // 定点格式的大数可能很长，先尝试栈上缓冲区，放不下时交给 snprintf
+    char digits[128];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value, format, precision);
+    if (result.ec != std::errc()) {
+        appendRawPrintf(out, spec, std::is_same<Float, long double>::value ? "L" : "", value);
+        return;
+    }
+    size_t n = static_cast<size_t>(result.ptr - digits);
+    if (conversion == 'F' || conversion == 'E' || conversion == 'G') {
+        for (size_t i = 0; i < n; ++i) {
+            if (digits[i] >= 'a' && digits[i] <= 'z') {
+                digits[i] = static_cast<char>(digits[i] - 'a' + 'A');
+            }
+        }
+    }
+    out.append(digits, n);
+#endif
+}
+
+inline void formatString(MessageBuffer& out, const FormatSpec& spec, const char* value) {
+    if (!value) {
+        value = "(null)";
+    }
+    size_t length = spec.precision >= 0 ? strnlen(value, static_cast<size_t>(spec.precision))
+                                        : std::strlen(value);
+    size_t padding = spec.width > 0 && static_cast<size_t>(spec.width) > length
+                         ? static_cast<size_t>(spec.width) - length : 0;
+    bool left = std::strchr(spec.flags, '-') != nullptr;
+    if (!left) {
+        out.append(padding, ' ');
+    }
+    out.append(value, length);
+    if (left) {
+        out.append(padding, ' ');
+    }
+}
+
+inline void formatPointer(MessageBuffer& out, const FormatSpec& spec, const void* value) {
+    if (!isPlainSpec(spec)) {
+        FormatSpec adjusted = spec;
+        adjusted.conversion = 'p';
+        adjusted.precision = -1;
+        appendRawPrintf(out, adjusted, "", value);
+        return;
+    }
+    if (!value) {
+        out.append("(nil)", 5);
+        return;
+    }
+    out.append("0x", 2);
+    appendUnsigned(out, reinterpret_cast<uintptr_t>(value), 16, false);
+}
+
+// 按参数的实际类型格式化一个转换说明
+inline void formatArg(MessageBuffer& out, const FormatSpec& spec, const FormatArg& arg) {
+    char conversion = spec.conversion;
+    bool integer_conversion = std::strchr("diouxXc", conversion) != nullptr;
+    bool float_conversion = std::strchr("fFeEgGaA", conversion) != nullptr;
+    switch (arg.type) {
+        case FormatArg::Type::SIGNED:
+        case FormatArg::Type::UNSIGNED:
+            if (integer_conversion) {
+                formatInteger(out, spec, arg);
+            } else if (float_conversion) {
+                double value = arg.type == FormatArg::Type::SIGNED ? static_cast<double>(arg.i)
+                                                                   : static_cast<double>(arg.u);
+                formatFloating(out, spec, value);
+            } else {
+                FormatSpec adjusted = spec;
+                adjusted.conversion = arg.is_char ? 'c' : 'd';
+                formatInteger(out, adjusted, arg);
+            }
+            break;
+        case FormatArg::Type::DOUBLE:
+        case FormatArg::Type::LONG_DOUBLE: {
+            FormatSpec adjusted = spec;
+            if (!float_conversion) {
+                adjusted.conversion = 'g';
+            }
+            if (arg.type == FormatArg::Type::DOUBLE) {
+                formatFloating(out, adjusted, arg.d);
+            } else {
+                formatFloating(out, adjusted, arg.ld);
+            }
+            break;
+        }
+        case FormatArg::Type::STRING:
+            if (conversion == 'p') {
+                formatPointer(out, spec, arg.s);
+            } else {
+                formatString(out, spec, arg.s);
+            }
+            break;
+        case FormatArg::Type::POINTER:
+            formatPointer(out, spec, arg.p);
+            break;
+    }
+}
+
+// 按 printf 语法把 args 格式化后追加到 out
+inline void formatArgs(MessageBuffer& out, const char* format, const FormatArg* args, size_t count) {
+    size_t next = 0;
+    const char* cursor = format;
+    while (*cursor) {
+        const char* percent = std::strchr(cursor, '%');
+        if (!percent) {
+            out.append(cursor, std::strlen(cursor));
+            break;
+        }
+        out.append(cursor, static_cast<size_t>(percent - cursor));
+        if (percent[1] == '%') {
+            out.push_back('%');
+            cursor = percent + 2;
+            continue;
+        }
+
+        // 解析标志、宽度、精度、长度修饰符和转换字符，'*' 各消耗一个整数参数
+        const char* p = percent + 1;
+        FormatSpec spec;
+        size_t flag_count = 0;
+        spec.flags[0] = '\0';
+        while (*p && std::strchr("-+ #0", *p)) {
+            if (flag_count + 1 < sizeof(spec.flags) && !std::strchr(spec.flags, *p)) {
+                spec.flags[flag_count++] = *p;
+                spec.flags[flag_count] = '\0';
+            }
+            ++p;
+        }
+        bool missing = false;
+        auto readNumber = [&](int& number) {
+            if (*p == '*') {
+                ++p;
+                if (next < count && (args[next].type == FormatArg::Type::SIGNED ||
+                                     args[next].type == FormatArg::Type::UNSIGNED)) {
+                    number = static_cast<int>(args[next++].i);
+                } else {
+                    missing = true;
+                }
+                return;
+            }
+            if (*p >= '0' && *p <= '9') {
+                number = 0;
+                while (*p >= '0' && *p <= '9') {
+                    number = std::min(number * 10 + (*p - '0'), 4096);
+                    ++p;
+                }
+            }
+        };
+        spec.width = -1;
+        spec.precision = -1;
+        readNumber(spec.width);
+        if (spec.width < -1) {
+            // 负的 '*' 宽度表示左对齐
+            spec.width = -spec.width;
+            if (!std::strchr(spec.flags, '-') && flag_count + 1 < sizeof(spec.flags)) {
+                spec.flags[flag_count++] = '-';
+                spec.flags[flag_count] = '\0';
+            }
+        }
+        if (*p == '.') {
+            ++p;
+            spec.precision = 0;
+            readNumber(spec.precision);
+            if (spec.precision < -1) {
+                spec.precision = -1;
+            }
+        }
+        while (*p && std::strchr("hlLqjzt", *p)) {
+            ++p;
+        }
+        if (*p == '\0') {
+            out.append(percent, static_cast<size_t>(p - percent));
+            break;
+        }
+        spec.conversion = *p++;
+        cursor = p;
+
+        if (!std::strchr("diouxXcfFeEgGaAspn", spec.conversion)) {
+            // 未知的转换字符原样输出，不消耗参数
+            out.append(percent, static_cast<size_t>(p - percent));
+            continue;
+        }
+        if (missing || next >= count) {
+            out.append(percent, static_cast<size_t>(p - percent));
+            continue;
+        }
+        const FormatArg& arg = args[next++];
+        if (spec.conversion != 'n') {
+            formatArg(out, spec, arg);
+        }
+    }
+}
+
+// 把 printf 风格的消息格式化后追加到 out；没有参数时按原样拷贝格式串
+template<typename... Args>
+inline void formatTo(MessageBuffer& out, const char* format, const Args&... args) {
+    if constexpr (sizeof...(Args) == 0) {
+        out.append(format, std::strlen(format));
+    } else {
+        const FormatArg list[] = {makeFormatArg(args)...};
+        formatArgs(out, format, list, sizeof...(Args));
+    }
+}
+
+// 编译期格式检查：只在 LOG_UTILS_CHECK_FORMAT 的不可达分支中调用，从不执行
+template<typename... Args>
+std::integral_constant<bool, (sizeof...(Args) > 0)> hasFormatArgs(const Args&...);
+
+inline void checkFormat(std::false_type, const char* format) {
+    (void)format;
+}
+
+#if defined(__GNUC__)
+__attribute__((format(printf, 2, 3)))
+#endif
+inline void checkFormat(std::true_type, const char* format, ...) {
+    (void)format;
+}
+
+} // namespace log_utils
+
+// 让编译器按 printf 规则检查字面量格式串与参数类型（-Wformat，-Wall 默认开启，可用 -Werror=format
+// 升级为错误）；参数不会被求值。没有参数的调用按原样输出格式串，不做检查
+#define LOG_UTILS_CHECK_FORMAT(format, ...) \
+    if (false) \
+        log_utils::checkFormat(decltype(log_utils::hasFormatArgs(__VA_ARGS__))(), format, ##__VA_ARGS__)
+
+#endif // LOG_UTILS_FORMAT_ENGINE_H
@@ -0,0 +1,110 @@
+#ifndef LOG_UTILS_JSON_SINK_H
+#define LOG_UTILS_JSON_SINK_H
+
+#include <mutex>
+#include <string>
+
+#include "log_utils/log_utils.h"
+#include "log_utils/kv_fields.h"
+
+namespace log_utils {
+
+// JSON 输出目标：每条日志写为一行 JSON（NDJSON），供离线分析直接读取，不需要解析文本。
+// LOG_KV 的记录写出事件名和带类型的字段，其他记录写出格式化好的消息：
+//   {"ts":1702000225123456,"time":"2023-12-07 14:30:25.123","level":"INFO","module":"Planner",
+//    "file":"planner.cpp","line":42,"event":"replan","fields":{"cost":1.5,"iters":3}}
+// ts 为 Unix 时间（微秒）。文件写入和刷新策略与 FileLogger 相同
+class JsonLogSink : public LogSink {
+private:
+    FileLogger file_;
+    std::mutex mutex_;
+    LogLevel min_level_;
+    std::string line_;  // 当前记录的渲染缓冲区
+
+    void appendFields(const LogEntry& entry) {
+        const LogKvSchema& schema = *entry.site->kv;
+        line_ += ",\"event\":";
+        appendJsonString(line_, schema.event);
+        // 同步和延迟格式化的记录都带有字段值的原始编码；超长而退回文本的记录只保留消息
+        if (!entry.formatter || !entry.args || entry.format != entry.site->format) {
+            if (!schema.keys.empty()) {
+                line_ += ",\"message\":";
+                appendJsonString(line_, entry.message, entry.message_size);
+            }
+            return;
+        }
+        line_ += ",\"fields\":{";
+        size_t start = line_.size();
+        bool complete = forEachKvField(schema.signature.c_str(), entry.args, entry.args_size,
+                                       [&](size_t index, const KvValue& value) {
+            if (index > 0) {
+                line_ += ',';
+            }
+            appendJsonString(line_, schema.keys[index]);
+            line_ += ':';
+            appendJsonValue(line_, value);
+        });
+        if (!complete) {
+            line_.resize(start);
+        }
+        line_ += '}';
+    }
+
+public:
+    JsonLogSink(const std::string& file_path, LogLevel min_level = LogLevel::DEBUG)
+        : file_(file_path, LogLevel::DEBUG), min_level_(min_level) {}
+
+    bool accepts(LogLevel level) const override {
+        return level >= min_level_ && file_.isOpen();
+    }
+
+    void write(const LogEntry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        char timestamp[kTimestampBufferSize];
+        formatTimestamp(entry.timestamp, timestamp);
+        long long us = static_cast<long long>(std::chrono::duration_cast<std::chrono::microseconds>(
+            entry.timestamp.time_since_epoch()).count());
+
+        line_.clear();
+        line_ += "{\"ts\":";
+        line_ += std::to_string(us);
+        line_ += ",\"time\":";
+        appendJsonString(line_, timestamp);
+        line_ += ",\"level\":\"";
+        line_ += logLevelName(entry.level);
+        line_ += "\",\"module\":";
+        appendJsonString(line_, entry.module);
+        line_ += ",\"file\":";
+        appendJsonString(line_, entry.file);
+        line_ += ",\"line\":";
+        line_ += std::to_string(entry.line);
+        if (entry.site && entry.site->kv) {
+            appendFields(entry);
+        } else {
+            line_ += ",\"message\":";
+            appendJsonString(line_, entry.message, entry.message_size);
+        }
+        line_ += "}\n";
+        file_.append(line_.data(), line_.size(), entry.level);
+    }
+
+    void flush() override {
+        file_.flush();
+    }
+
+    void flushIfDue(std::chrono::steady_clock::time_point now) override {
+        file_.flushIfDue(now);
+    }
+
+    void setFlushOptions(const FlushOptions& options) override {
+        file_.setFlushOptions(options);
+    }
+
+    const std::string& getFilePath() const {
+        return file_.getFilePath();
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_JSON_SINK_H
@@ -0,0 +1,202 @@
+#ifndef LOG_UTILS_KV_FIELDS_H
+#define LOG_UTILS_KV_FIELDS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+// 结构化日志（LOG_KV）的字段描述与编解码，不依赖 ROS
+//
+// 每个 LOG_KV 调用处在首次执行时生成一份 LogKvSchema：事件名、字段名和各字段值的类型代码
+// （见 scalarTypeCode）。字段值按 arg_capture.h 的参数编码保存在记录中，文本日志按
+// "<事件> key=value ..." 格式化，JSON 与二进制日志直接使用原始编码
+
+namespace log_utils {
+
+struct LogKvSchema {
+    const char* event;
+    std::vector<const char*> keys;  // 指向调用处的字面量
+    std::string signature;          // 各字段值的类型代码
+    std::string format;             // 文本日志使用的格式串
+};
+
+// 类型代码对应的文本格式（值按默认参数提升后传入 snprintf）
+inline const char* kvFormatSpec(char code) {
+    switch (code) {
+        case 'b': case 'h': case 'i': case 'B': case 'H': return "%d";
+        case 'I': return "%u";
+        case 'l': return "%lld";
+        case 'L': return "%llu";
+        case 'f': case 'd': return "%g";
+        case 'D': return "%Lg";
+        case 'p': return "%p";
+        case 's': return "%s";
+        default:  return "?";
+    }
+}
+
+// 格式串中的 '%' 需要转义
+inline void appendFormatLiteral(std::string& out, const char* text) {
+    for (; *text; ++text) {
+        if (*text == '%') {
+            out += '%';
+        }
+        out += *text;
+    }
+}
+
+inline void buildKvFormat(LogKvSchema& schema) {
+    schema.format.clear();
+    appendFormatLiteral(schema.format, schema.event ? schema.event : "");
+    for (size_t i = 0; i < schema.keys.size(); ++i) {
+        schema.format += ' ';
+        appendFormatLiteral(schema.format, schema.keys[i] ? schema.keys[i] : "");
+        schema.format += '=';
+        schema.format += kvFormatSpec(schema.signature[i]);
+    }
+}
+
+// 解码后的字段值
+struct KvValue {
+    char code;
+    int64_t i;
+    uint64_t u;
+    long double f;
+    const char* s;     // 字符串内容（'s'），空指针时为空
+    uint32_t s_size;
+    const void* p;
+};
+
+template<typename T>
+inline T readKvScalar(const char*& in) {
+    T value;
+    std::memcpy(&value, in, sizeof(T));
+    in += sizeof(T);
+    return value;
+}
+
+// 按类型代码依次解码字段值，对每个字段调用 on_field(index, value)；数据不完整时返回 false
+template<typename Callback>
+inline bool forEachKvField(const char* signature, const char* data, size_t size, Callback&& on_field) {
+    const char* in = data;
+    const char* end = data + size;
+    for (size_t index = 0; signature[index] != '\0'; ++index) {
+        char code = signature[index];
+        KvValue value{code, 0, 0, 0, nullptr, 0, nullptr};
+        size_t width = 0;
+        switch (code) {
+            case 'b': case 'B': width = 1; break;
+            case 'h': case 'H': width = 2; break;
+            case 'i': case 'I': case 'f': width = 4; break;
+            case 'l': case 'L': case 'd': width = 8; break;
+            case 'D': width = sizeof(long double); break;
+            case 'p': width = sizeof(void*); break;
+            case 's': width = sizeof(uint32_t); break;
+            default:  return false;
+        }
+        if (static_cast<size_t>(end - in) < width) {
+            return false;
+        }
+        switch (code) {
+            case 'b': value.i = readKvScalar<int8_t>(in); break;
+            case 'h': value.i = readKvScalar<int16_t>(in); break;
+            case 'i': value.i = readKvScalar<int32_t>(in); break;
+            case 'l': value.i = readKvScalar<int64_t>(in); break;
+            case 'B': value.u = readKvScalar<uint8_t>(in); break;
+            case 'H': value.u = readKvScalar<uint16_t>(in); break;
+            case 'I': value.u = readKvScalar<uint32_t>(in); break;
+            case 'L': value.u = readKvScalar<uint64_t>(in); break;
+            case 'f': value.f = readKvScalar<float>(in); break;
+            case 'd': value.f = readKvScalar<double>(in); break;
+            case 'D': value.f = readKvScalar<long double>(in); break;
+            case 'p': value.p = readKvScalar<const void*>(in); break;
+            case 's': {
+                uint32_t length = readKvScalar<uint32_t>(in);
+                if (length != UINT32_MAX) {
+                    if (static_cast<size_t>(end - in) < static_cast<size_t>(length) + 1) {
+                        return false;
+                    }
+                    value.s = in;
+                    value.s_size = length;
+                    in += length + 1;
+                }
+                break;
+            }
+        }
+        on_field(index, value);
+    }
+    return true;
+}
+
+// 追加 JSON 字符串（含引号），控制字符按 \uXXXX 转义，非 ASCII 字节原样保留
+inline void appendJsonString(std::string& out, const char* text, size_t size) {
+    out += '"';
+    for (size_t i = 0; i < size; ++i) {
+        unsigned char ch = static_cast<unsigned char>(text[i]);
+        switch (ch) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (ch < 0x20) {
+                    char escaped[8];
+                    std::snprintf(escaped, sizeof(escaped), "\\u%04x", ch);
+                    out += escaped;
+                } else {
+                    out += static_cast<char>(ch);
+                }
+        }
+    }
+    out += '"';
+}
+
+inline void appendJsonString(std::string& out, const char* text) {
+    appendJsonString(out, text, std::strlen(text));
+}
+
+// 追加 JSON 值：整数为数字，浮点数保留完整精度（非有限值写为 null），指针为十六进制字符串
+inline void appendJsonValue(std::string& out, const KvValue& value) {
+    char buffer[64];
+    switch (value.code) {
+        case 'b': case 'h': case 'i': case 'l':
+            std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(value.i));
+            out += buffer;
+            break;
+        case 'B': case 'H': case 'I': case 'L':
+            std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(value.u));
+            out += buffer;
+            break;
+        case 'f': case 'd': case 'D': {
+            double number = static_cast<double>(value.f);
+            if (number != number || number - number != 0) {
+                out += "null";
+            } else {
+                std::snprintf(buffer, sizeof(buffer), value.code == 'f' ? "%.9g" : "%.17g", number);
+                out += buffer;
+            }
+            break;
+        }
+        case 'p':
+            std::snprintf(buffer, sizeof(buffer), "\"%p\"", value.p);
+            out += buffer;
+            break;
+        case 's':
+            if (value.s) {
+                appendJsonString(out, value.s, value.s_size);
+            } else {
+                out += "null";
+            }
+            break;
+        default:
+            out += "null";
+    }
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_KV_FIELDS_H
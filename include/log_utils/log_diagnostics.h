@@ -0,0 +1,134 @@
+#ifndef LOG_UTILS_LOG_DIAGNOSTICS_H
+#define LOG_UTILS_LOG_DIAGNOSTICS_H
+
+#include <map>
+#include <string>
+
+#include <ros/ros.h>
+#include <diagnostic_msgs/DiagnosticArray.h>
+
+#include "log_utils/log_utils.h"
+
+namespace log_utils {
+
+// 把 LogManager::getStats() 周期发布到 /diagnostics（diagnostic_msgs/DiagnosticArray）：
+// 一条 "<节点名>/log_utils" 汇总状态和每个模块一条 "<节点名>/log_utils/<模块>" 状态，
+// 带有各计数器的当前值和本周期的速率。本周期有记录因队列满被丢弃时状态为 WARN
+//   log_utils::LogStatsPublisher stats_publisher(nh, ros::Duration(1.0));
+class LogStatsPublisher {
+private:
+    ros::Publisher publisher_;
+    ros::Timer timer_;
+    std::string name_;
+    LogStats last_;
+    std::map<std::string, LogModuleStats> last_modules_;
+    ros::Time last_time_;
+
+    static void addValue(diagnostic_msgs::DiagnosticStatus& status, const char* key, uint64_t value) {
+        diagnostic_msgs::KeyValue pair;
+        pair.key = key;
+        pair.value = std::to_string(value);
+        status.values.push_back(pair);
+    }
+
+    static void addRate(diagnostic_msgs::DiagnosticStatus& status, const char* key,
+                        uint64_t value, uint64_t last, double seconds) {
+        diagnostic_msgs::KeyValue pair;
+        pair.key = key;
+        char buffer[32];
+        double delta = value >= last ? static_cast<double>(value - last) : static_cast<double>(value);
+        std::snprintf(buffer, sizeof(buffer), "%.1f", seconds > 0 ? delta / seconds : 0.0);
+        pair.value = buffer;
+        status.values.push_back(pair);
+    }
+
+    void onTimer(const ros::TimerEvent&) {
+        publish();
+    }
+
+public:
+    LogStatsPublisher(ros::NodeHandle& nh, ros::Duration period = ros::Duration(1.0),
+                      const std::string& topic = "/diagnostics")
+        : name_(ros::this_node::getName() + "/log_utils"),
+          last_(LogManager::getInstance().getStats()), last_time_(ros::Time::now()) {
+        for (const auto& module : last_.modules) {
+            last_modules_[module.module] = module;
+        }
+        publisher_ = nh.advertise<diagnostic_msgs::DiagnosticArray>(topic, 10);
+        timer_ = nh.createTimer(period, &LogStatsPublisher::onTimer, this);
+    }
+
+    LogStatsPublisher(const LogStatsPublisher&) = delete;
+    LogStatsPublisher& operator=(const LogStatsPublisher&) = delete;
+
+    // 立即发布一次（定时器回调也调用这里）
+    void publish() {
+        LogStats stats = LogManager::getInstance().getStats();
+        ros::Time now = ros::Time::now();
+        double seconds = (now - last_time_).toSec();
+
+        diagnostic_msgs::DiagnosticArray array;
+        array.header.stamp = now;
+
+        diagnostic_msgs::DiagnosticStatus summary;
+        summary.name = name_;
+        summary.hardware_id = ros::this_node::getName();
+        bool dropping = stats.dropped_queue > last_.dropped_queue;
+        bool shedding = stats.dropped_overload > last_.dropped_overload;
+        summary.level = dropping || shedding ? diagnostic_msgs::DiagnosticStatus::WARN
+                                             : diagnostic_msgs::DiagnosticStatus::OK;
+        summary.message = dropping ? "log records dropped (queue full)"
+                                   : shedding ? "log records shed (overload)" : "OK";
+        addValue(summary, "submitted", stats.submitted);
+        addRate(summary, "submitted/s", stats.submitted, last_.submitted, seconds);
+        addValue(summary, "dropped_queue", stats.dropped_queue);
+        addValue(summary, "dropped_throttled", stats.dropped_throttled);
+        addValue(summary, "dropped_overload", stats.dropped_overload);
+        addValue(summary, "bytes", stats.bytes);
+        addRate(summary, "bytes/s", stats.bytes, last_.bytes, seconds);
+        addValue(summary, "bytes_written", stats.bytes_written);
+        addValue(summary, "flushes", stats.flushes);
+        addRate(summary, "flushes/s", stats.flushes, last_.flushes, seconds);
+        addValue(summary, "queue_depth", stats.queue_depth);
+        addValue(summary, "queue_high_water", stats.queue_high_water);
+        addValue(summary, "queue_capacity", stats.queue_capacity);
+        addValue(summary, "writer_lag_ns", stats.writer_lag_ns);
+        addValue(summary, "writer_max_lag_ns", stats.writer_max_lag_ns);
+        addValue(summary, "realtime_violations", stats.realtime_violations);
+        addValue(summary, "latency_p50_ns", stats.latency_p50_ns);
+        addValue(summary, "latency_p99_ns", stats.latency_p99_ns);
+        addValue(summary, "latency_p999_ns", stats.latency_p999_ns);
+        addValue(summary, "latency_max_ns", stats.latency_max_ns);
+        array.status.push_back(summary);
+
+        for (const auto& module : stats.modules) {
+            const LogModuleStats& last = last_modules_[module.module];
+            diagnostic_msgs::DiagnosticStatus status;
+            status.name = name_ + "/" + module.module;
+            status.hardware_id = summary.hardware_id;
+            bool module_dropping = module.dropped_queue > last.dropped_queue;
+            bool module_shedding = module.dropped_overload > last.dropped_overload;
+            status.level = module_dropping || module_shedding ? diagnostic_msgs::DiagnosticStatus::WARN
+                                                              : diagnostic_msgs::DiagnosticStatus::OK;
+            status.message = module_dropping ? "log records dropped (queue full)"
+                                             : module_shedding ? "log records shed (overload)" : "OK";
+            addValue(status, "submitted", module.submitted);
+            addRate(status, "submitted/s", module.submitted, last.submitted, seconds);
+            addValue(status, "dropped_queue", module.dropped_queue);
+            addValue(status, "dropped_throttled", module.dropped_throttled);
+            addValue(status, "dropped_overload", module.dropped_overload);
+            addValue(status, "bytes", module.bytes);
+            addRate(status, "bytes/s", module.bytes, last.bytes, seconds);
+            array.status.push_back(status);
+            last_modules_[module.module] = module;
+        }
+
+        publisher_.publish(array);
+        last_ = std::move(stats);
+        last_time_ = now;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_LOG_DIAGNOSTICS_H
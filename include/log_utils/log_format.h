@@ -0,0 +1,91 @@
+#ifndef LOG_UTILS_LOG_FORMAT_H
+#define LOG_UTILS_LOG_FORMAT_H
+
+#include <charconv>
+#include <cstddef>
+#include <string>
+
+// 日志级别与单行文本格式，不依赖 ROS，离线工具（如 log_decode）也使用这里的定义
+
+namespace log_utils {
+
+// 日志级别枚举
+enum class LogLevel {
+    DEBUG = 0,
+    INFO = 1,
+    WARN = 2,
+    ERROR = 3
+};
+
+constexpr int kLogLevelCount = 4;
+
+// 日志级别转字符串
+inline std::string logLevelToString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+// 日志级别名称（静态字符串，不分配内存）
+inline const char* logLevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO:  return "INFO";
+        case LogLevel::WARN:  return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "UNKNOWN";
+    }
+}
+
+// 解析级别名称（DEBUG/INFO/WARN/ERROR，不区分大小写），无法识别时返回 false
+inline bool parseLogLevel(const std::string& name, LogLevel& level) {
+    static const char* const kNames[] = {"DEBUG", "INFO", "WARN", "ERROR"};
+    for (int i = 0; i < 4; ++i) {
+        const char* expected = kNames[i];
+        size_t n = 0;
+        while (n < name.size() && expected[n] &&
+               (name[n] == expected[n] || name[n] == expected[n] - 'A' + 'a')) {
+            ++n;
+        }
+        if (n == name.size() && expected[n] == '\0') {
+            level = static_cast<LogLevel>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+// 异步模式下日志记录消息区的长度，更长的消息另行在堆上分配
+constexpr size_t kLogRecordMessageSize = 1024;
+
+// 单条消息的最大长度，超出部分截断
+constexpr size_t kMaxLogMessageSize = 64 * 1024;
+
+// 按统一格式渲染一行日志并追加到 out：
+// [时间戳] [级别] [模块] 文件:行号 - 消息
+inline void renderLine(std::string& out, const char* timestamp, LogLevel level, const char* module,
+                       const char* file, int line, const char* message, size_t message_size) {
+    char line_buffer[16];
+    auto line_end = std::to_chars(line_buffer, line_buffer + sizeof(line_buffer), line).ptr;
+    out += '[';
+    out += timestamp;
+    out += "] [";
+    out += logLevelName(level);
+    out += "] [";
+    out += module;
+    out += "] ";
+    out += file;
+    out += ':';
+    out.append(line_buffer, line_end);
+    out += " - ";
+    out.append(message, message_size);
+    out += '\n';
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_LOG_FORMAT_H
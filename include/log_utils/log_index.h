@@ -0,0 +1,155 @@
+#ifndef LOG_UTILS_LOG_INDEX_H
+#define LOG_UTILS_LOG_INDEX_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 文本日志的稀疏索引文件格式（FileLogger 写入，log_query 工具读取），不依赖 ROS
+//
+// 索引文件为日志文件路径加 .idx 后缀，由文件头和若干定长的块描述组成。每个块覆盖日志文件中一段
+// 连续的完整记录（约 block_bytes 字节），记录这段数据的偏移和长度、记录数、时间范围
+// （system_clock 微秒）、出现过的级别，以及按模块名哈希的 256 位位图（有误报、无漏报）。
+// 查询时只读取可能匹配的块，块内仍逐行过滤。索引只用于加速：没有被块覆盖的区间
+// （启用索引之前写入的部分、最后一个未写满的块等）由查询工具完整扫描。
+// 块描述按写入机器的字节序保存，需要在相同架构上查询
+
+namespace log_utils {
+
+constexpr char kLogIndexMagic[8] = {'L', 'O', 'G', 'I', 'D', 'X', '1', '\0'};
+constexpr uint32_t kLogIndexVersion = 1;
+constexpr const char* kLogIndexSuffix = ".idx";
+
+struct LogIndexHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t block_bytes;
+};
+
+struct LogIndexBlock {
+    uint64_t offset;       // 第一条记录在日志文件中的偏移
+    uint64_t size;         // 块内记录的总字节数
+    int64_t min_time_us;   // 块内记录时间戳的最小值和最大值
+    int64_t max_time_us;
+    uint32_t records;
+    uint32_t level_mask;   // 第 n 位表示块内有级别为 n 的记录
+    uint64_t module_bits[4];
+};
+
+// 索引配置，在 LogManager::setIndexOptions 中对所有文本日志文件生效
+struct LogIndexOptions {
+    bool enabled = false;
+    size_t block_bytes = 64 * 1024;  // 每个块覆盖的日志字节数
+};
+
+inline std::string logIndexPath(const std::string& log_path) {
+    return log_path + kLogIndexSuffix;
+}
+
+// 模块名在位图中的位置（FNV-1a 的低 8 位）
+inline unsigned logIndexModuleBit(const char* module, size_t size) {
+    uint64_t hash = 1469598103934665603ULL;
+    for (size_t i = 0; i < size; ++i) {
+        hash = (hash ^ static_cast<unsigned char>(module[i])) * 1099511628211ULL;
+    }
+    return static_cast<unsigned>(hash & 255);
+}
+
+inline bool logIndexHasModule(const LogIndexBlock& block, unsigned bit) {
+    return (block.module_bits[bit / 64] >> (bit % 64)) & 1;
+}
+
+// 累积一个块的描述，记录按文件偏移递增的顺序加入
+class LogIndexBuilder {
+private:
+    LogIndexBlock block_;
+
+public:
+    LogIndexBuilder() {
+        reset();
+    }
+
+    void add(uint64_t offset, size_t size, int64_t time_us, int level, unsigned module_bit) {
+        if (block_.records == 0) {
+            block_.offset = offset;
+            block_.min_time_us = time_us;
+            block_.max_time_us = time_us;
+        }
+        block_.size = offset + size - block_.offset;
+        block_.min_time_us = std::min(block_.min_time_us, time_us);
+        block_.max_time_us = std::max(block_.max_time_us, time_us);
+        ++block_.records;
+        block_.level_mask |= 1u << (level & 31);
+        block_.module_bits[module_bit / 64] |= 1ULL << (module_bit % 64);
+    }
+
+    bool empty() const {
+        return block_.records == 0;
+    }
+
+    const LogIndexBlock& block() const {
+        return block_;
+    }
+
+    void reset() {
+        std::memset(&block_, 0, sizeof(block_));
+    }
+};
+
+// 读取与日志文件（当前大小 file_size）一致的块：按偏移递增、互不重叠且不超出文件。
+// 遇到第一个不一致的块即停止（如日志文件被截断或替换），索引不存在或无法识别时返回空
+inline std::vector<LogIndexBlock> readLogIndex(const std::string& index_path, uint64_t file_size) {
+    std::vector<LogIndexBlock> blocks;
+    int fd = ::open(index_path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return blocks;
+    }
+    std::string data;
+    struct stat st;
+    if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+        data.resize(static_cast<size_t>(st.st_size));
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t n = ::read(fd, &data[offset], data.size() - offset);
+            if (n <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(n);
+        }
+        data.resize(offset);
+    }
+    ::close(fd);
+
+    LogIndexHeader header;
+    if (data.size() < sizeof(header)) {
+        return blocks;
+    }
+    std::memcpy(&header, data.data(), sizeof(header));
+    if (std::memcmp(header.magic, kLogIndexMagic, sizeof(kLogIndexMagic)) != 0 ||
+        header.version != kLogIndexVersion) {
+        return blocks;
+    }
+    uint64_t end = 0;
+    for (size_t offset = sizeof(header); offset + sizeof(LogIndexBlock) <= data.size();
+         offset += sizeof(LogIndexBlock)) {
+        LogIndexBlock block;
+        std::memcpy(&block, data.data() + offset, sizeof(block));
+        if (block.offset < end || block.size > file_size || block.offset > file_size - block.size) {
+            break;
+        }
+        blocks.push_back(block);
+        end = block.offset + block.size;
+    }
+    return blocks;
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_LOG_INDEX_H
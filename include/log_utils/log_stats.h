@@ -0,0 +1,207 @@
+#ifndef LOG_UTILS_LOG_STATS_H
+#define LOG_UTILS_LOG_STATS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "log_utils/ring_buffer.h"
+#include "log_utils/rate_limit.h"
+
+// 日志系统自身的统计，不依赖 ROS
+//
+// 计数器只做 relaxed 原子加，不加锁；生产者延迟每 kLatencySampleInterval 次调用采样一次，
+// 按耗时的 2 的幂分桶。读取时各计数器分别加载，快照内的数值之间不保证严格一致
+
+namespace log_utils {
+
+// 生产者延迟的采样间隔（调用次数，2 的幂）
+constexpr uint32_t kLatencySampleInterval = 64;
+
+// 原子地把 target 提高到 value（已更大时不写入）
+inline void atomicStoreMax(std::atomic<uint64_t>& target, uint64_t value) {
+    uint64_t current = target.load(std::memory_order_relaxed);
+    while (value > current &&
+           !target.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+// 每个模块一份的计数器，独占缓存行，不同模块的计数互不干扰
+struct alignas(kCacheLineSize) LogCounters {
+    std::atomic<uint64_t> submitted{0};          // 交给输出目标或异步队列的记录数（含之后被丢弃的）
+    std::atomic<uint64_t> dropped_queue{0};      // 异步队列满而丢弃的记录数
+    std::atomic<uint64_t> dropped_throttled{0};  // 被 LOG_EVERY_N 等限流宏拦截的调用数
+    std::atomic<uint64_t> dropped_overload{0};   // 过载保护丢弃的记录数（队列占用过高或超出预算）
+    std::atomic<uint64_t> bytes{0};              // 渲染后的日志字节数（每条记录计一次）
+
+    void reset() {
+        submitted.store(0, std::memory_order_relaxed);
+        dropped_queue.store(0, std::memory_order_relaxed);
+        dropped_throttled.store(0, std::memory_order_relaxed);
+        dropped_overload.store(0, std::memory_order_relaxed);
+        bytes.store(0, std::memory_order_relaxed);
+    }
+};
+
+// 按耗时的 2 的幂分桶的直方图：桶 0 记录 0 纳秒，桶 i 记录 [2^(i-1), 2^i) 纳秒的样本
+class LatencyHistogram {
+public:
+    static constexpr size_t kBuckets = 64;
+
+private:
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> max_ns_{0};
+
+    static size_t bucketOf(uint64_t ns) {
+        size_t bucket = 0;
+        while (ns > 0 && bucket + 1 < kBuckets) {
+            ns >>= 1;
+            ++bucket;
+        }
+        return bucket;
+    }
+
+public:
+    void record(uint64_t ns) {
+        buckets_[bucketOf(ns)].fetch_add(1, std::memory_order_relaxed);
+        atomicStoreMax(max_ns_, ns);
+    }
+
+    uint64_t count() const {
+        uint64_t total = 0;
+        for (const auto& bucket : buckets_) {
+            total += bucket.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    uint64_t max() const {
+        return max_ns_.load(std::memory_order_relaxed);
+    }
+
+    // 分位数 q（0 到 1）所在桶的上界（纳秒，不超过最大样本），没有样本时为 0
+    uint64_t percentile(double q) const {
+        uint64_t counts[kBuckets];
+        uint64_t total = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            counts[i] = buckets_[i].load(std::memory_order_relaxed);
+            total += counts[i];
+        }
+        if (total == 0) {
+            return 0;
+        }
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < kBuckets; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                uint64_t upper = i + 1 < kBuckets ? (uint64_t(1) << i) - 1 : UINT64_MAX;
+                return std::min(upper, max());
+            }
+        }
+        return max();
+    }
+
+    void reset() {
+        for (auto& bucket : buckets_) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        max_ns_.store(0, std::memory_order_relaxed);
+    }
+};
+
+// 进程级的统计（与 LogManager 无关，文件写入和写线程也在这里计数）
+// 成员都是平凡析构的原子变量，程序退出时其他静态对象析构期间仍可安全访问
+class LogStatsRecorder {
+private:
+    LogStatsRecorder() = default;
+
+public:
+    std::atomic<uint64_t> bytes_written{0};     // 实际写入日志文件的字节数
+    std::atomic<uint64_t> flushes{0};           // 写入文件的系统调用批次数
+    std::atomic<uint64_t> queue_high_water{0};  // 异步队列的最大深度（条）
+    std::atomic<uint64_t> writer_lag_ns{0};     // 写线程最近处理的记录从产生到写出的延迟
+    std::atomic<uint64_t> writer_max_lag_ns{0};
+    std::atomic<uint64_t> realtime_violations{0};  // 实时线程中违反约束的日志调用数（见 realtime.h）
+    LatencyHistogram producer_latency;          // LOG 调用在调用线程内的耗时（采样）
+
+    static LogStatsRecorder& getInstance() {
+        static LogStatsRecorder instance;
+        return instance;
+    }
+
+    LogStatsRecorder(const LogStatsRecorder&) = delete;
+    LogStatsRecorder& operator=(const LogStatsRecorder&) = delete;
+
+    void reset() {
+        bytes_written.store(0, std::memory_order_relaxed);
+        flushes.store(0, std::memory_order_relaxed);
+        queue_high_water.store(0, std::memory_order_relaxed);
+        writer_lag_ns.store(0, std::memory_order_relaxed);
+        writer_max_lag_ns.store(0, std::memory_order_relaxed);
+        realtime_violations.store(0, std::memory_order_relaxed);
+        producer_latency.reset();
+    }
+};
+
+// 采样一次生产者延迟：构造到析构之间的耗时，未被选中的调用只增加一个线程局部计数
+class ProducerLatencySample {
+private:
+    int64_t start_ns_;
+
+public:
+    ProducerLatencySample() {
+        thread_local uint32_t calls = 0;
+        start_ns_ = (++calls & (kLatencySampleInterval - 1)) == 0 ? steadyNanoseconds() : 0;
+    }
+
+    ~ProducerLatencySample() {
+        if (start_ns_ != 0) {
+            LogStatsRecorder::getInstance().producer_latency.record(
+                static_cast<uint64_t>(steadyNanoseconds() - start_ns_));
+        }
+    }
+
+    ProducerLatencySample(const ProducerLatencySample&) = delete;
+    ProducerLatencySample& operator=(const ProducerLatencySample&) = delete;
+};
+
+// 单个模块的统计快照
+struct LogModuleStats {
+    std::string module;
+    uint64_t submitted = 0;
+    uint64_t dropped_queue = 0;
+    uint64_t dropped_throttled = 0;
+    uint64_t dropped_overload = 0;
+    uint64_t bytes = 0;
+};
+
+// LogManager::getStats() 返回的快照；前五项为所有模块之和
+struct LogStats {
+    uint64_t submitted = 0;
+    uint64_t dropped_queue = 0;
+    uint64_t dropped_throttled = 0;
+    uint64_t dropped_overload = 0;
+    uint64_t bytes = 0;
+    uint64_t bytes_written = 0;
+    uint64_t flushes = 0;
+    uint64_t queue_depth = 0;  // 读取快照时的异步队列深度
+    uint64_t queue_high_water = 0;
+    uint64_t queue_capacity = 0;  // 未启用过异步模式时为 0
+    uint64_t writer_lag_ns = 0;
+    uint64_t writer_max_lag_ns = 0;
+    uint64_t realtime_violations = 0;
+    uint64_t latency_samples = 0;
+    uint64_t latency_p50_ns = 0;
+    uint64_t latency_p99_ns = 0;
+    uint64_t latency_p999_ns = 0;
+    uint64_t latency_max_ns = 0;
+    std::vector<LogModuleStats> modules;
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_LOG_STATS_H
@@ -0,0 +1,339 @@
+#ifndef LOG_UTILS_LOG_STREAM_H
+#define LOG_UTILS_LOG_STREAM_H
+
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ios>
+#include <memory>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "log_utils/format_engine.h"
+#include "log_utils/realtime.h"
+
+// LOG_STREAM 使用的输出流，不依赖 ROS
+//
+// LogStream 把常见类型（数值、字符、字符串、指针、Eigen 矩阵和向量）直接格式化进线程级的
+// MessageBuffer，输出与 std::ostream 的默认格式相同，但不经过 locale、sentry 和虚函数。
+// 其他类型、std::endl / std::setprecision 等操纵符交给建立在同一缓冲区上的 std::ostream，
+// 之后的插入也都经过该 std::ostream，使操纵符设置的格式对后续插入生效。
+// 需要快速输出自定义类型时可以重载 operator<<(LogStream&, const T&)
+
+namespace log_utils {
+
+// 以 MessageBuffer 为存储的 streambuf：流直接写入消息缓冲区的空闲空间，写满时扩展缓冲区，
+// 到达 kMaxLogMessageSize 后丢弃多出的字符
+class MessageStreamBuf : public std::streambuf {
+private:
+    MessageBuffer& message_;
+
+public:
+    explicit MessageStreamBuf(MessageBuffer& message) : message_(message) {
+        reset();
+    }
+
+    // 把已写入的字符计入缓冲区，并把写入区重新指向缓冲区末尾（至少 min_space 字节）；
+    // 绕过流直接写入缓冲区之后，需要先调用一次再通过流写入
+    void settle(size_t min_space = 0) {
+        message_.commit(static_cast<size_t>(pptr() - pbase()));
+        size_t space = message_.reserve(min_space);
+        setp(message_.end(), message_.end() + space);
+    }
+
+    void reset() {
+        message_.clear();
+        setp(message_.end(), message_.end() + (message_.capacity() - message_.size()));
+    }
+
+protected:
+    int_type overflow(int_type ch) override {
+        settle(message_.capacity());
+        if (!traits_type::eq_int_type(ch, traits_type::eof()) && pptr() < epptr()) {
+            *pptr() = traits_type::to_char_type(ch);
+            pbump(1);
+        }
+        return traits_type::not_eof(ch);
+    }
+};
+
+// 具有 Eigen 稠密矩阵接口（Matrix、Array、Map、Block 及表达式）且元素为数值的类型
+template<typename T, typename = void>
+struct IsEigenDense : std::false_type {};
+
+template<typename T>
+struct IsEigenDense<T, std::void_t<decltype(T::RowsAtCompileTime), decltype(T::ColsAtCompileTime),
+                                   typename T::Scalar, decltype(std::declval<const T&>().eval())>>
+    : std::integral_constant<bool, std::is_arithmetic<typename T::Scalar>::value &&
+                                   !std::is_same<typename T::Scalar, char>::value &&
+                                   !std::is_same<typename T::Scalar, signed char>::value &&
+                                   !std::is_same<typename T::Scalar, unsigned char>::value> {};
+
+class LogStream {
+private:
+    MessageBuffer& message_;
+    MessageStreamBuf& buffer_;
+    std::ostream& stream_;
+    bool streaming_;
+
+    // 按 std::ostream 的默认格式转换一个数值（浮点数为 %g、精度 6），返回写入的字节数
+    template<typename T>
+    static size_t formatNumber(char (&digits)[64], T value) {
+        std::to_chars_result result;
+        if constexpr (std::is_same<T, bool>::value) {
+            digits[0] = value ? '1' : '0';
+            return 1;
+        } else if constexpr (std::is_floating_point<T>::value) {
+            // float 与 ostream 相同，先提升为 double
+            using Float = typename std::conditional<std::is_same<T, float>::value, double, T>::type;
+#ifdef LOG_UTILS_HAVE_FLOAT_TO_CHARS
+            result = std::to_chars(digits, digits + sizeof(digits), static_cast<Float>(value),
+                                   std::chars_format::general, 6);
+#else
+            // 标准库没有浮点数的 std::to_chars 时（libstdc++ 11 之前）由 snprintf 转换
+            int n = std::is_same<Float, long double>::value
+                        ? std::snprintf(digits, sizeof(digits), "%Lg", static_cast<long double>(value))
+                        : std::snprintf(digits, sizeof(digits), "%g", static_cast<double>(value));
+            return n > 0 ? std::min(static_cast<size_t>(n), sizeof(digits) - 1) : 0;
+#endif
+        } else {
+            result = std::to_chars(digits, digits + sizeof(digits), value);
+        }
+        return result.ec == std::errc() ? static_cast<size_t>(result.ptr - digits) : 0;
+    }
+
+    // 与 Eigen 默认 IOFormat 相同：元素按最宽者右对齐，列间一个空格，行间换行
+    template<typename Matrix>
+    void appendMatrix(const Matrix& matrix) {
+        char digits[64];
+        size_t width = 0;
+        for (decltype(matrix.rows()) i = 0; i < matrix.rows(); ++i) {
+            for (decltype(matrix.cols()) j = 0; j < matrix.cols(); ++j) {
+                width = std::max(width, formatNumber(digits, matrix.coeff(i, j)));
+            }
+        }
+        for (decltype(matrix.rows()) i = 0; i < matrix.rows(); ++i) {
+            if (i > 0) {
+                message_.push_back('\n');
+            }
+            for (decltype(matrix.cols()) j = 0; j < matrix.cols(); ++j) {
+                if (j > 0) {
+                    message_.push_back(' ');
+                }
+                size_t n = formatNumber(digits, matrix.coeff(i, j));
+                message_.append(width - n, ' ');
+                message_.append(digits, n);
+            }
+        }
+    }
+
+public:
+    LogStream(MessageBuffer& message, MessageStreamBuf& buffer, std::ostream& stream)
+        : message_(message), buffer_(buffer), stream_(stream), streaming_(false) {}
+
+    LogStream(const LogStream&) = delete;
+    LogStream& operator=(const LogStream&) = delete;
+
+    // 是否已切换到 std::ostream（插入过操纵符或没有快速实现的类型）
+    bool streaming() const {
+        return streaming_;
+    }
+
+    // 切换到 std::ostream，之后的插入都经过它
+    std::ostream& stream() {
+        if (!streaming_) {
+            buffer_.settle();
+            streaming_ = true;
+        }
+        return stream_;
+    }
+
+    // 直接追加到消息（供自定义 operator<< 使用；已切换到 std::ostream 时改经流写入）
+    LogStream& write(const char* text, size_t size) {
+        if (streaming_) {
+            stream_.write(text, static_cast<std::streamsize>(size));
+        } else {
+            message_.append(text, size);
+        }
+        return *this;
+    }
+
+    // 开始一条新消息
+    void reset() {
+        buffer_.reset();
+        streaming_ = false;
+    }
+
+    const char* data() {
+        if (streaming_) {
+            buffer_.settle();
+        }
+        return message_.data();
+    }
+
+    size_t size() {
+        if (streaming_) {
+            buffer_.settle();
+        }
+        return message_.size();
+    }
+
+    template<typename T>
+    LogStream& operator<<(const T& value) {
+        using Type = typename std::remove_cv<T>::type;
+        if (streaming_) {
+            stream_ << value;
+        } else if constexpr (std::is_same<Type, char>::value || std::is_same<Type, signed char>::value ||
+                             std::is_same<Type, unsigned char>::value) {
+            message_.push_back(static_cast<char>(value));
+        } else if constexpr (std::is_arithmetic<Type>::value) {
+            char digits[64];
+            message_.append(digits, formatNumber(digits, value));
+        } else if constexpr (std::is_array<Type>::value &&
+                             std::is_same<typename std::remove_cv<typename std::remove_extent<Type>::type>::type,
+                                          char>::value) {
+            message_.append(value, std::strlen(value));
+        } else if constexpr (std::is_same<Type, const char*>::value || std::is_same<Type, char*>::value) {
+            // 与 LOG 的 %s 相同，空指针写为 "(null)"（std::ostream 会置 badbit 并丢弃后续输出）
+            if (value) {
+                message_.append(value, std::strlen(value));
+            } else {
+                message_.append("(null)", 6);
+            }
+        } else if constexpr (std::is_same<Type, std::string>::value || std::is_same<Type, std::string_view>::value) {
+            message_.append(value.data(), value.size());
+        } else if constexpr (std::is_pointer<Type>::value &&
+                             std::is_void<typename std::remove_cv<typename std::remove_pointer<Type>::type>::type>::value) {
+            // 与 libstdc++ 相同：非空指针为 0x 开头的十六进制，空指针为 0
+            if (value) {
+                message_.append("0x", 2);
+                appendUnsigned(message_, reinterpret_cast<uintptr_t>(value), 16, false);
+            } else {
+                message_.push_back('0');
+            }
+        } else if constexpr (IsEigenDense<Type>::value) {
+            // 表达式（如 a + b、矩阵乘积）先求值，与 Eigen 自身的 operator<< 相同
+            auto&& evaluated = value.eval();
+            appendMatrix(evaluated);
+        } else {
+            stream() << value;
+        }
+        return *this;
+    }
+
+    // 其他指针与 std::ostream 相同，按 void* 输出（函数指针按 bool 输出）
+    template<typename T>
+    LogStream& operator<<(T* value) {
+        if constexpr (std::is_function<T>::value) {
+            stream() << value;
+            return *this;
+        } else {
+            return operator<< <const void*>(static_cast<const void*>(value));
+        }
+    }
+
+    LogStream& operator<<(const char* value) {
+        return operator<< <const char*>(value);
+    }
+
+    LogStream& operator<<(char* value) {
+        return operator<< <const char*>(value);
+    }
+
+    // std::endl、std::hex 等操纵符
+    LogStream& operator<<(std::ostream& (*manipulator)(std::ostream&)) {
+        manipulator(stream());
+        return *this;
+    }
+
+    LogStream& operator<<(std::ios_base& (*manipulator)(std::ios_base&)) {
+        manipulator(stream());
+        return *this;
+    }
+
+    LogStream& operator<<(std::basic_ios<char>& (*manipulator)(std::basic_ios<char>&)) {
+        manipulator(stream());
+        return *this;
+    }
+};
+
+// LOG_STREAM 的线程级输出流：缓冲区、std::ostream 和 LogStream 每个线程只构造一次
+struct StreamScratch {
+    InlineMessageBuffer<kLogRecordMessageSize> message;
+    MessageStreamBuf buffer;
+    std::ostream stream;
+    LogStream log;
+    std::ios_base::fmtflags default_flags;
+    bool in_use;
+
+    StreamScratch()
+        : buffer(message), stream(&buffer), log(message, buffer, stream),
+          default_flags(stream.flags()), in_use(false) {}
+};
+
+inline StreamScratch& streamScratch() {
+    thread_local StreamScratch scratch;
+    return scratch;
+}
+
+// 借用当前线程的输出流；流插入过程中再次调用 LOG_STREAM 时改用临时对象
+class ScopedLogStream {
+private:
+    StreamScratch* scratch_;
+    std::unique_ptr<StreamScratch> nested_;
+
+public:
+    ScopedLogStream() {
+        StreamScratch& scratch = streamScratch();
+        if (scratch.in_use) {
+            if (isRealtimeThread()) {
+                noteRealtimeViolation();
+            }
+            nested_.reset(new StreamScratch());
+            scratch_ = nested_.get();
+        } else {
+            scratch_ = &scratch;
+        }
+        scratch_->in_use = true;
+        scratch_->log.reset();
+    }
+
+    ~ScopedLogStream() {
+        // 用过 std::ostream 时恢复默认格式状态，与每次新建 ostringstream 的行为一致
+        if (scratch_->log.streaming()) {
+            std::ostream& stream = scratch_->stream;
+            stream.clear();
+            stream.flags(scratch_->default_flags);
+            stream.precision(6);
+            stream.width(0);
+            stream.fill(' ');
+        }
+        scratch_->in_use = false;
+    }
+
+    ScopedLogStream(const ScopedLogStream&) = delete;
+    ScopedLogStream& operator=(const ScopedLogStream&) = delete;
+
+    LogStream& get() {
+        return scratch_->log;
+    }
+
+    const char* data() const {
+        return scratch_->log.data();
+    }
+
+    size_t size() const {
+        return scratch_->log.size();
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_LOG_STREAM_H
@@ -8,20 +8,46 @@
 #include <fstream>
 #include <memory>
 #include <map>
+#include <set>
+#include <vector>
 #include <mutex>
 #include <cstdlib>
 #include <chrono>
 #include <iomanip>
+#include <atomic>
+#include <thread>
+#include <tuple>
+#include <utility>
+#include <condition_variable>
+#include <cstring>
+#include <algorithm>
+#include <charconv>
+#include <cerrno>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
-namespace log_utils {
+#include "log_utils/ring_buffer.h"
+#include "log_utils/arg_capture.h"
+#include "log_utils/timestamp.h"
+#include "log_utils/log_format.h"
+#include "log_utils/rotation.h"
+#include "log_utils/flight_recorder.h"
+#include "log_utils/rate_limit.h"
+#include "log_utils/shm_ring.h"
+#include "log_utils/kv_fields.h"
+#include "log_utils/log_stats.h"
+#include "log_utils/format_engine.h"
+#include "log_utils/log_stream.h"
+#include "log_utils/batch_write.h"
+#include "log_utils/realtime.h"
+#include "log_utils/thread_options.h"
+#include "log_utils/string_index.h"
+#include "log_utils/log_index.h"
+#include "log_utils/trace.h"
 
-// 日志级别枚举
-enum class LogLevel {
-    DEBUG = 0,
-    INFO = 1,
-    WARN = 2,
-    ERROR = 3
-};
+namespace log_utils {
 
 // 获取文件名（不包含路径）
 inline std::string getFileName(const std::string& path) {
@@ -29,182 +55,2075 @@ inline std::string getFileName(const std::string& path) {
     return (pos == std::string::npos) ? path : path.substr(pos + 1);
 }
 
+// 获取文件名（不包含路径），返回指向 path 内部的指针；可在编译期对 __FILE__ 求值
+constexpr const char* baseName(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') {
+            base = p + 1;
+        }
+    }
+    return base;
+}
+
 // 获取当前时间戳字符串
 inline std::string getCurrentTimestamp() {
-    auto now = std::chrono::system_clock::now();
-    auto time_t = std::chrono::system_clock::to_time_t(now);
-    auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
-        now.time_since_epoch()) % 1000;
+    char buffer[kTimestampBufferSize];
+    size_t size = formatTimestamp(std::chrono::system_clock::now(), buffer);
+    return std::string(buffer, size);
+}
 
-    std::stringstream ss;
-    ss << std::put_time(std::localtime(&time_t), "%Y-%m-%d %H:%M:%S");
-    ss << "." << std::setfill('0') << std::setw(3) << ms.count();
-    return ss.str();
+// 截断复制字符串到定长缓冲区，返回复制的长度（不含结尾 '\0'）
+inline size_t copyTruncated(char* dst, size_t capacity, const char* src, size_t length) {
+    size_t n = length < capacity - 1 ? length : capacity - 1;
+    std::memcpy(dst, src, n);
+    dst[n] = '\0';
+    return n;
 }
 
-// 日志级别转字符串
-inline std::string logLevelToString(LogLevel level) {
-    switch (level) {
-        case LogLevel::DEBUG: return "DEBUG";
-        case LogLevel::INFO:  return "INFO";
-        case LogLevel::WARN:  return "WARN";
-        case LogLevel::ERROR: return "ERROR";
-        default: return "UNKNOWN";
+class LogModule;
+
+// LOG 调用处的静态元数据，每个调用处一份，首次执行时构造并注册
+// id 为进程内唯一的紧凑编号（从 1 开始），二进制日志等场景可用它代替重复的字符串
+struct LogCallSite {
+    const char* module_name;
+    LogLevel level;
+    const char* file;    // 不含路径的文件名
+    int line;
+    const char* format;  // 字面量格式串；运行时格式串或 LOG_STREAM 为空
+    uint32_t id;
+    LogModule* module;   // 已解析的模块
+    const LogKvSchema* kv;  // LOG_KV 调用处的字段描述，其他调用处为空
+
+    LogCallSite(const char* module_name, LogLevel level, const char* file, int line,
+                const char* format, const LogKvSchema* kv = nullptr);
+
+    // 模块级别或飞行记录器是否需要这条日志
+    bool isEnabled() const;
+
+    LogCallSite(const LogCallSite&) = delete;
+    LogCallSite& operator=(const LogCallSite&) = delete;
+};
+
+// 所有调用处元数据的注册表
+class CallSiteRegistry {
+private:
+    mutable std::mutex mutex_;
+    std::vector<const LogCallSite*> sites_;
+
+public:
+    static CallSiteRegistry& getInstance() {
+        static CallSiteRegistry instance;
+        return instance;
+    }
+
+    uint32_t add(const LogCallSite* site) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sites_.push_back(site);
+        return static_cast<uint32_t>(sites_.size());
+    }
+
+    // 按编号查找，编号无效时返回空
+    const LogCallSite* find(uint32_t id) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return (id == 0 || id > sites_.size()) ? nullptr : sites_[id - 1];
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return sites_.size();
     }
+};
+
+// 返回字面量格式串本身，供 LOG_UTILS_CALL_SITE 在编译期选定
+inline const char* asStaticFormat(const char* format) {
+    return format;
 }
 
+// 异步队列中的定长日志记录，生产者只做一次拷贝
+// formatter 非空时 message 中保存的是待格式化的参数，由写线程按 format 格式化；
+// 超过 message 容量的消息保存在 overflow 指向的堆内存中，由写线程写出后释放
+struct LogRecord {
+    std::chrono::system_clock::time_point timestamp;
+    LogModule* module;  // 所属模块，决定写入哪些输出目标
+    const LogCallSite* site;  // 调用处元数据，按模块名动态写入的记录为空
+    LogLevel level;
+    int line;
+    const char* file;   // 不含路径的文件名，指向静态存储的字符串
+    const DeferredFormatter* formatter;
+    const char* format;
+    char* overflow;
+    uint32_t message_size;
+    char message[kLogRecordMessageSize];
+
+    const char* messageData() const {
+        return overflow ? overflow : message;
+    }
+};
+
+// 刷新策略
+enum class FlushPolicy {
+    EVERY_RECORD = 0,   // 每条记录后立即写入文件（默认）
+    ON_SEVERITY = 1,    // 遇到不低于 flush_level 的记录时写入
+    EVERY_N_BYTES = 2,  // 缓冲累计达到 flush_bytes 时写入
+    INTERVAL = 3        // 每隔 flush_interval 由 LogManager 的定时线程写入
+};
+
+struct FlushOptions {
+    FlushPolicy policy = FlushPolicy::EVERY_RECORD;
+    LogLevel flush_level = LogLevel::ERROR;
+    size_t flush_bytes = 64 * 1024;
+    std::chrono::milliseconds flush_interval = std::chrono::milliseconds(100);
+};
+
+// 任何策略下缓冲区的上限，超过后立即写入，避免内存无限增长
+constexpr size_t kMaxBufferedBytes = 1024 * 1024;
+
+// 交给输出目标的一条日志；text 为渲染好的整行（含结尾换行），所有输出目标共享同一份
+struct LogEntry {
+    std::chrono::system_clock::time_point timestamp;
+    LogLevel level;
+    const char* module;
+    const char* file;  // 不含路径的文件名
+    int line;
+    const char* message;
+    size_t message_size;
+    const char* text;
+    size_t text_size;
+    const LogCallSite* site;  // 调用处元数据，按模块名动态写入的日志为空
+    // 写线程延迟格式化的记录保留原始格式串和参数编码，其他记录为空
+    const DeferredFormatter* formatter;
+    const char* format;
+    const char* args;
+    size_t args_size;
+};
+
+// 日志输出目标（文件、汇总文件等），每个模块把同一条渲染结果分发给订阅它的所有输出目标
+class LogSink {
+public:
+    virtual ~LogSink() = default;
+
+    // 是否接收该级别的日志
+    virtual bool accepts(LogLevel level) const {
+        (void)level;
+        return true;
+    }
+
+    virtual void write(const LogEntry& entry) = 0;
+
+    virtual void flush() {}
+
+    // INTERVAL 刷新策略下由定时线程周期调用
+    virtual void flushIfDue(std::chrono::steady_clock::time_point now) {
+        (void)now;
+    }
+
+    virtual void setFlushOptions(const FlushOptions& options) {
+        (void)options;
+    }
+};
+
+class FileLogger;
+
+// 写线程的批量写入：写线程处理队列期间，需要写入文件的 FileLogger 只在这里登记，
+// 每处理 kWriteBatchRecords 条记录和队列清空时由 submit() 把所有文件的数据一次提交（见 batch_write.h）
+class WriteBatch {
+private:
+    std::mutex mutex_;
+    std::vector<FileLogger*> pending_;
+    std::vector<BatchWrite> writes_;
+    std::unique_ptr<BatchFileWriter> writer_;
+    bool use_io_uring_ = true;
+
+    WriteBatch() = default;
+
+public:
+    static WriteBatch& getInstance() {
+        static WriteBatch instance;
+        return instance;
+    }
+
+    WriteBatch(const WriteBatch&) = delete;
+    WriteBatch& operator=(const WriteBatch&) = delete;
+
+    // 当前线程是否处于写线程的处理周期（此时 FileLogger 的写入推迟到 submit）
+    static bool& active() {
+        thread_local bool active = false;
+        return active;
+    }
+
+    // 下次创建写入器时是否尝试 io_uring
+    void setUseIoUring(bool use_io_uring) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (use_io_uring != use_io_uring_) {
+            use_io_uring_ = use_io_uring;
+            writer_.reset();
+        }
+    }
+
+    bool usingIoUring() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!writer_) {
+            writer_.reset(new BatchFileWriter(use_io_uring_));
+        }
+        return writer_->usingIoUring();
+    }
+
+    // 只有处理周期内的线程会调用 add 和 submit
+    void add(FileLogger* logger) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.push_back(logger);
+    }
+
+    // FileLogger 析构时调用，之后不再访问该对象
+    void cancel(FileLogger* logger) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        pending_.erase(std::remove(pending_.begin(), pending_.end(), logger), pending_.end());
+    }
+
+    // 写出所有登记的 FileLogger 的缓冲区
+    void submit();
+};
+
+// 写线程每处理这么多条记录提交一次批量写入，限制推迟写入的数据量
+constexpr size_t kWriteBatchRecords = 256;
+
 // 文件日志记录器
-class FileLogger {
+class FileLogger : public LogSink {
+    friend class WriteBatch;
+
 private:
     std::string log_file_path_;
-    std::ofstream log_file_;
+    int fd_;  // 首次写入文件时打开，轮转时由后台线程持锁替换
+    std::atomic<bool> failed_;  // 打开文件失败，之后丢弃写入
     std::mutex mutex_;
-    LogLevel min_level_;
+    std::atomic<int> min_level_;
+    FlushOptions flush_options_;
+    std::string buffer_;  // 尚未写入文件的数据
+    std::chrono::steady_clock::time_point last_flush_;
+
+    // 轮转状态：文件改名、打开新文件和压缩都在后台线程完成，日志线程只在切换 fd 时持锁
+    RotationOptions rotation_options_;
+    size_t file_bytes_;  // 当前文件的大小
+    std::chrono::steady_clock::time_point opened_at_;
+    bool rotation_pending_;
+
+    bool batch_pending_;  // 已在 WriteBatch 中登记、等待提交
+
+    // 稀疏索引：缓冲区中每条记录的位置和属性，写入文件后累积到当前块，块写满时追加到索引文件
+    // 没有属性的数据（如直接追加的文本）记为 kUnindexedLevel，在此处结束当前块，留给查询工具完整扫描
+    static constexpr uint8_t kUnindexedLevel = 0xFF;
+    struct IndexedRecord {
+        uint32_t offset;  // 在 buffer_ 中的偏移
+        uint32_t size;
+        int64_t time_us;
+        uint8_t level;
+        uint8_t module_bit;
+    };
+    LogIndexOptions index_options_;
+    std::vector<IndexedRecord> index_records_;
+    LogIndexBuilder index_block_;
+    int index_fd_;
+    bool index_truncate_;  // 日志文件是新建的，打开索引时丢弃同名的旧索引
+
+    // 打开日志文件，所在目录不存在时先创建
+    static int openLogFile(const std::string& path) {
+        int fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (fd < 0 && errno == ENOENT) {
+            std::string dir, stem, extension;
+            splitLogPath(path, dir, stem, extension);
+            if (createDirectories(dir)) {
+                fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            }
+        }
+        return fd;
+    }
+
+    // 第一次有数据要写入时才打开文件（异步模式下即在写线程中），之前的记录留在缓冲区；
+    // 打开失败时输出一次错误，之后该文件不再接收日志（调用方持有 mutex_）
+    bool openLocked() {
+        if (fd_ >= 0) {
+            return true;
+        }
+        if (failed_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        fd_ = openLogFile(log_file_path_);
+        if (fd_ < 0) {
+            failed_.store(true, std::memory_order_relaxed);
+            std::cerr << "Error: Cannot open log file: " << log_file_path_ << std::endl;
+            return false;
+        }
+        struct stat st;
+        if (::fstat(fd_, &st) == 0) {
+            file_bytes_ = static_cast<size_t>(st.st_size);
+        }
+        index_truncate_ = file_bytes_ == 0;
+        opened_at_ = std::chrono::steady_clock::now();
+        return true;
+    }
+
+    // 把当前块追加到索引文件；索引文件无法打开时停止建立索引
+    void writeIndexBlockLocked() {
+        if (index_block_.empty()) {
+            return;
+        }
+        if (index_fd_ < 0) {
+            int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (index_truncate_ ? O_TRUNC : 0);
+            index_fd_ = ::open(logIndexPath(log_file_path_).c_str(), flags, 0644);
+            if (index_fd_ < 0) {
+                std::cerr << "Error: Cannot open log index: " << logIndexPath(log_file_path_) << std::endl;
+                index_options_.enabled = false;
+                index_block_.reset();
+                return;
+            }
+            index_truncate_ = false;
+            struct stat st;
+            if (::fstat(index_fd_, &st) == 0 && st.st_size == 0) {
+                LogIndexHeader header;
+                std::memcpy(header.magic, kLogIndexMagic, sizeof(header.magic));
+                header.version = kLogIndexVersion;
+                header.block_bytes = static_cast<uint32_t>(index_options_.block_bytes);
+                writeFully(index_fd_, reinterpret_cast<const char*>(&header), sizeof(header));
+            }
+        }
+        writeFully(index_fd_, reinterpret_cast<const char*>(&index_block_.block()), sizeof(LogIndexBlock));
+        index_block_.reset();
+    }
+
+    void closeIndexLocked() {
+        writeIndexBlockLocked();
+        if (index_fd_ >= 0) {
+            ::close(index_fd_);
+            index_fd_ = -1;
+        }
+    }
+
+    // 缓冲区的前 written 字节已写到文件偏移 base 处，把其中完整的记录加入索引
+    void indexWrittenLocked(size_t base, size_t written) {
+        for (const IndexedRecord& record : index_records_) {
+            if (record.offset + record.size > written) {
+                break;
+            }
+            if (record.level == kUnindexedLevel) {
+                writeIndexBlockLocked();
+                continue;
+            }
+            index_block_.add(base + record.offset, record.size, record.time_us, record.level, record.module_bit);
+            if (index_block_.block().size >= index_options_.block_bytes) {
+                writeIndexBlockLocked();
+            }
+        }
+        index_records_.clear();
+    }
+
+    // 把缓冲区写入文件（调用方持有 mutex_）
+    void flushLocked() {
+        size_t written = 0;
+        if (!buffer_.empty() && openLocked()) {
+            written = writeFully(fd_, buffer_.data(), buffer_.size());
+        }
+        finishFlushLocked(written);
+    }
+
+    // 缓冲区已写入 offset 字节（其余数据因写入出错而丢弃）后的记账和轮转检查
+    void finishFlushLocked(size_t offset) {
+        if (offset > 0) {
+            LogStatsRecorder& stats = LogStatsRecorder::getInstance();
+            stats.bytes_written.fetch_add(offset, std::memory_order_relaxed);
+            stats.flushes.fetch_add(1, std::memory_order_relaxed);
+        }
+        size_t end = file_bytes_ + offset;
+        if (!index_records_.empty() && offset > 0 && fd_ >= 0) {
+            // O_APPEND 下写入后的文件位置即本次数据的末尾；与本进程的计数不一致说明其他进程也在追加
+            // 同一文件（如多个节点共用汇总日志），记录的实际位置无法确定，停止建立索引
+            off_t position = ::lseek(fd_, 0, SEEK_CUR);
+            if (position >= 0) {
+                end = static_cast<size_t>(position);
+            }
+            if (position < 0 || end != file_bytes_ + offset) {
+                std::cerr << "Warning: Log file is shared with another process, index disabled: "
+                          << log_file_path_ << std::endl;
+                index_records_.clear();
+                closeIndexLocked();
+                index_options_.enabled = false;
+            }
+        }
+        if (!index_records_.empty()) {
+            indexWrittenLocked(file_bytes_, offset);
+        }
+        buffer_.clear();
+        file_bytes_ = end;
+        last_flush_ = std::chrono::steady_clock::now();
+        if (rotation_options_.max_bytes > 0 && file_bytes_ >= rotation_options_.max_bytes) {
+            requestRotationLocked();
+        }
+    }
+
+    void requestRotationLocked() {
+        if (rotation_pending_ || file_bytes_ == 0) {
+            return;
+        }
+        rotation_pending_ = true;
+        BackgroundWorker::getInstance().post(this, [this] { rotate(); });
+    }
+
+    void checkAgeLocked(std::chrono::steady_clock::time_point now) {
+        if (rotation_options_.max_age.count() > 0 && now - opened_at_ >= rotation_options_.max_age) {
+            requestRotationLocked();
+        }
+    }
+
+    // 在后台线程执行：把当前文件改名为轮转文件并打开新文件，然后压缩、清理旧文件
+    // 改名后日志线程仍可写入旧 fd（数据进入轮转文件），持锁期间只交换 fd
+    void rotate() {
+        std::string rotated_path = rotatedFilePath(log_file_path_);
+        int new_fd = -1;
+        if (::rename(log_file_path_.c_str(), rotated_path.c_str()) == 0) {
+            new_fd = ::open(log_file_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        }
+
+        RotationOptions options;
+        int old_fd = -1;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            rotation_pending_ = false;
+            options = rotation_options_;
+            if (new_fd >= 0) {
+                old_fd = fd_;
+                fd_ = new_fd;
+                // 已写入旧文件的记录留在旧索引中（只有未压缩的轮转文件保留索引），新文件重新建立索引
+                if (index_fd_ >= 0 || !index_block_.empty()) {
+                    closeIndexLocked();
+                    std::string index_path = logIndexPath(log_file_path_);
+                    if (options.compression == Compression::NONE) {
+                        ::rename(index_path.c_str(), logIndexPath(rotated_path).c_str());
+                    } else {
+                        ::unlink(index_path.c_str());
+                    }
+                }
+                index_truncate_ = true;
+            }
+            // 失败时同样重新计数，等下一个周期再重试，避免每次写入都尝试轮转
+            file_bytes_ = 0;
+            opened_at_ = std::chrono::steady_clock::now();
+        }
+        if (new_fd < 0) {
+            std::cerr << "Error: Cannot rotate log file: " << log_file_path_ << std::endl;
+            return;
+        }
+        ::close(old_fd);
+
+        compressFile(rotated_path, options.compression);
+        pruneRotatedFiles(log_file_path_, options.max_files);
+    }
+
+    bool shouldFlush(LogLevel level) const {
+        if (buffer_.size() >= kMaxBufferedBytes) {
+            return true;
+        }
+        switch (flush_options_.policy) {
+            case FlushPolicy::EVERY_RECORD:  return true;
+            case FlushPolicy::ON_SEVERITY:   return level >= flush_options_.flush_level;
+            case FlushPolicy::EVERY_N_BYTES: return buffer_.size() >= flush_options_.flush_bytes;
+            case FlushPolicy::INTERVAL:      return false;
+        }
+        return true;
+    }
 
 public:
     FileLogger(const std::string& file_path, LogLevel min_level = LogLevel::DEBUG)
-        : log_file_path_(file_path), min_level_(min_level) {
-        log_file_.open(log_file_path_, std::ios::app);
-        if (!log_file_.is_open()) {
-            std::cerr << "Error: Cannot open log file: " << log_file_path_ << std::endl;
+        : log_file_path_(file_path), fd_(-1), failed_(false), min_level_(static_cast<int>(min_level)),
+          last_flush_(std::chrono::steady_clock::now()), file_bytes_(0),
+          opened_at_(std::chrono::steady_clock::now()), rotation_pending_(false), batch_pending_(false),
+          index_fd_(-1), index_truncate_(false) {
+        // 先构造后台线程和批量写入的单例，保证它们晚于本对象析构
+        BackgroundWorker::getInstance();
+        WriteBatch::getInstance();
+    }
+
+    ~FileLogger() override {
+        BackgroundWorker::getInstance().cancel(this);
+        WriteBatch::getInstance().cancel(this);
+        flushLocked();
+        closeIndexLocked();
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    void log(LogLevel level, const std::string& module, const std::string& file,
+             int line, const std::string& message) {
+        if (!accepts(level)) {
+            return;
+        }
+        auto now = std::chrono::system_clock::now();
+        char timestamp[kTimestampBufferSize];
+        formatTimestamp(now, timestamp);
+        const char* file_name = baseName(file.c_str());
+        std::string text;
+        renderLine(text, timestamp, level, module.c_str(), file_name, line, message.c_str(), message.size());
+        LogEntry entry{now, level, module.c_str(), file_name, line, message.c_str(), message.size(),
+                       text.data(), text.size(), nullptr, nullptr, nullptr, nullptr, 0};
+        append(text.data(), text.size(), level, &entry);
+    }
+
+    bool accepts(LogLevel level) const override {
+        return static_cast<int>(level) >= min_level_.load(std::memory_order_relaxed) &&
+               !failed_.load(std::memory_order_relaxed);
+    }
+
+    // 运行时调整本文件接收的最低级别
+    void setMinLevel(LogLevel level) {
+        min_level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+
+    LogLevel getMinLevel() const {
+        return static_cast<LogLevel>(min_level_.load(std::memory_order_relaxed));
+    }
+
+    void write(const LogEntry& entry) override {
+        append(entry.text, entry.text_size, entry.level, &entry);
+    }
+
+    // 追加一行已渲染的日志，按刷新策略决定是否写入文件；启用了索引时 entry 提供该记录的索引属性，
+    // 为空时（如分片合并写入的文本）这段数据不进入任何块
+    void append(const char* text, size_t size, LogLevel level, const LogEntry* entry = nullptr) {
+        if (failed_.load(std::memory_order_relaxed)) {
+            return;
+        }
+        bool defer = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (entry && index_options_.enabled) {
+                auto time_us = std::chrono::duration_cast<std::chrono::microseconds>(
+                    entry->timestamp.time_since_epoch()).count();
+                index_records_.push_back(IndexedRecord{
+                    static_cast<uint32_t>(buffer_.size()), static_cast<uint32_t>(size),
+                    static_cast<int64_t>(time_us), static_cast<uint8_t>(level),
+                    static_cast<uint8_t>(logIndexModuleBit(entry->module, std::strlen(entry->module)))});
+            } else if (index_options_.enabled) {
+                index_records_.push_back(IndexedRecord{
+                    static_cast<uint32_t>(buffer_.size()), static_cast<uint32_t>(size), 0, kUnindexedLevel, 0});
+            }
+            buffer_.append(text, size);
+            if (shouldFlush(level)) {
+                if (!WriteBatch::active()) {
+                    flushLocked();
+                } else if (!batch_pending_) {
+                    batch_pending_ = true;
+                    defer = true;
+                }
+            }
+            if (rotation_options_.max_age.count() > 0) {
+                checkAgeLocked(std::chrono::steady_clock::now());
+            }
+        }
+        // 释放本对象的锁之后再登记，WriteBatch 的锁总是先于 FileLogger 的锁获取
+        if (defer) {
+            WriteBatch::getInstance().add(this);
+        }
+    }
+
+    void setFlushOptions(const FlushOptions& options) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_options_ = options;
+        flushLocked();
+    }
+
+    // 立即把缓冲区写入文件
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flushLocked();
+    }
+
+    // INTERVAL 策略下由定时线程调用，距上次写入超过 flush_interval 时刷新
+    void flushIfDue(std::chrono::steady_clock::time_point now) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!buffer_.empty() && now - last_flush_ >= flush_options_.flush_interval) {
+            flushLocked();
+        }
+        checkAgeLocked(now);
+    }
+
+    // 设置轮转策略，超出 max_bytes 或 max_age 时由后台线程轮转
+    void setRotationOptions(const RotationOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rotation_options_ = options;
+        if (options.max_bytes > 0 && file_bytes_ >= options.max_bytes) {
+            requestRotationLocked();
+        }
+    }
+
+    // 文件可以写入：已经打开，或尚未写入过（首次写入时打开）
+    bool isOpen() const {
+        return !failed_.load(std::memory_order_relaxed);
+    }
+
+    // 设置稀疏索引（写入 <日志文件>.idx，供 log_query 按时间、模块和级别查询）；关闭时写出当前块
+    void setIndexOptions(const LogIndexOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!options.enabled) {
+            index_records_.clear();
+            closeIndexLocked();
+        }
+        index_options_ = options;
+    }
+
+    const std::string& getFilePath() const {
+        return log_file_path_;
+    }
+};
+
+// 提交期间持有各 FileLogger 的锁，轮转不会在写入途中关闭旧 fd。各 FileLogger 按地址顺序加锁，
+// 其他线程每次只持有一个 FileLogger 的锁，且持锁时不会获取本对象的锁，不会形成死锁
+inline void WriteBatch::submit() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (pending_.empty()) {
+        return;
+    }
+    std::sort(pending_.begin(), pending_.end());
+    if (!writer_) {
+        writer_.reset(new BatchFileWriter(use_io_uring_));
+    }
+    std::vector<std::unique_lock<std::mutex>> locks;
+    locks.reserve(pending_.size());
+    writes_.clear();
+    for (FileLogger* logger : pending_) {
+        locks.emplace_back(logger->mutex_);
+        logger->batch_pending_ = false;
+        // 打开失败的文件写入 0 字节，随后丢弃其缓冲区
+        bool ready = !logger->buffer_.empty() && logger->openLocked();
+        writes_.push_back(BatchWrite{logger->fd_, logger->buffer_.data(), ready ? logger->buffer_.size() : 0, 0});
+    }
+    writer_->writeAll(writes_.data(), writes_.size());
+    for (size_t i = 0; i < pending_.size(); ++i) {
+        // 登记后被 flush() 等直接写出的缓冲区为空，这里只做记账
+        pending_[i]->finishFlushLocked(writes_[i].written);
+    }
+    pending_.clear();
+}
+
+// 日志模块：每个模块名对应一个实例，保存该模块输出目标列表的只读快照
+// 快照以原子指针发布，读者无锁遍历；旧快照保留到模块销毁，保证正在遍历的读者安全
+class LogModule {
+private:
+    using SinkList = std::vector<LogSink*>;
+
+    std::string name_;
+    std::shared_ptr<FileLogger> file_logger_;            // 模块专用日志文件，可能为空
+    std::vector<std::shared_ptr<LogSink>> extra_sinks_;  // 仅订阅该模块的附加输出目标
+    std::atomic<const SinkList*> sinks_;
+    std::vector<std::unique_ptr<const SinkList>> published_;
+    std::atomic<int> level_;  // 生效的最低级别：匹配的模块级别规则，或全局最低级别
+    mutable LogCounters counters_;
+
+    // 过载保护：字节预算在写出时消耗，记录数预算在放行时消耗；按级别统计丢弃数，
+    // shed_reported_ 为上次汇总时的计数（只在 LogManager 的 overload_mutex_ 内访问）
+    mutable RateBudget byte_budget_;
+    RateBudget record_budget_;
+    std::atomic<uint64_t> shed_levels_[kLogLevelCount] = {};
+    uint64_t shed_reported_[kLogLevelCount] = {};
+
+    friend class LogManager;
+
+    // 发布新的输出目标列表（由 LogManager 在其互斥锁内调用）
+    void publishSinks(const std::vector<std::shared_ptr<LogSink>>& global_sinks) {
+        std::unique_ptr<SinkList> list(new SinkList());
+        if (file_logger_) {
+            list->push_back(file_logger_.get());
+        }
+        for (const auto& sink : extra_sinks_) {
+            list->push_back(sink.get());
+        }
+        for (const auto& sink : global_sinks) {
+            list->push_back(sink.get());
+        }
+        sinks_.store(list.get(), std::memory_order_release);
+        published_.push_back(std::move(list));
+    }
+
+public:
+    LogModule(const std::string& name, std::shared_ptr<FileLogger> file_logger)
+        : name_(name), file_logger_(std::move(file_logger)), sinks_(nullptr),
+          level_(static_cast<int>(LogLevel::DEBUG)) {}
+
+    LogModule(const LogModule&) = delete;
+    LogModule& operator=(const LogModule&) = delete;
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    const std::shared_ptr<FileLogger>& fileLogger() const {
+        return file_logger_;
+    }
+
+    // 该级别的日志是否写入本模块的输出目标，LOG 宏在格式化之前检查
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= level_.load(std::memory_order_relaxed);
+    }
+
+    LogLevel level() const {
+        return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+    }
+
+    // 本模块的统计计数器
+    LogCounters& counters() const {
+        return counters_;
+    }
+
+    // 限流宏拦截了一次调用
+    void noteThrottled() const {
+        counters_.dropped_throttled.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // 把一条已渲染的日志分发给所有接收该级别的输出目标
+    void dispatch(const LogEntry& entry) const {
+        const SinkList* sinks = sinks_.load(std::memory_order_acquire);
+        if (!sinks) {
+            return;
+        }
+        counters_.bytes.fetch_add(entry.text_size, std::memory_order_relaxed);
+        if (byte_budget_.limited()) {
+            byte_budget_.charge(entry.text_size, steadyNanoseconds());
+        }
+        for (LogSink* sink : *sinks) {
+            if (sink->accepts(entry.level)) {
+                sink->write(entry);
+            }
         }
     }
+};
+
+// 共享内存输出目标（LOG_TRANSPORT=shm）：把渲染好的日志写入本进程的共享内存环形缓冲区，
+// 由 log_collector 统一排序后写入汇总日志和模块日志，本进程不再打开任何日志文件
+class SharedMemorySink : public LogSink {
+private:
+    ShmRingWriter ring_;
+    std::mutex mutex_;
+
+public:
+    SharedMemorySink(const std::string& log_dir, size_t capacity = kDefaultShmRingSize)
+        : ring_(log_dir, capacity) {}
+
+    bool accepts(LogLevel level) const override {
+        (void)level;
+        return ring_.isOpen();
+    }
+
+    void write(const LogEntry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        ring_.push(static_cast<uint64_t>(steadyNanoseconds()), static_cast<uint8_t>(entry.level),
+                   entry.module, std::strlen(entry.module), entry.text, entry.text_size);
+    }
+
+    bool isOpen() const {
+        return ring_.isOpen();
+    }
+
+    // 收集器来不及读取而丢弃的记录数
+    uint64_t dropped() const {
+        return ring_.dropped();
+    }
+
+    const std::string& name() const {
+        return ring_.name();
+    }
+};
+
+// 异步队列满时的处理策略
+enum class OverflowPolicy {
+    BLOCK = 0,        // 阻塞生产者直到有空位
+    DROP_NEWEST = 1,  // 丢弃当前这条记录
+    DROP_OLDEST = 2   // 丢弃队列中最早的一条记录
+};
+
+// 异步写线程在队列为空时的等待方式
+enum class WaitStrategy {
+    BLOCKING = 0,   // 在条件变量上休眠，由生产者唤醒（futex），空闲时不占用 CPU
+    BUSY_POLL = 1,  // 持续轮询队列，延迟最低但独占一个 CPU，生产者不再需要唤醒写线程
+    ADAPTIVE = 2    // 先轮询一段时间，再让出 CPU，仍为空时转为 BLOCKING
+};
 
-    ~FileLogger() {
-        if (log_file_.is_open()) {
-            log_file_.close();
+// 异步模式配置
+struct AsyncOptions {
+    size_t queue_capacity = 4096;  // 队列容量（记录条数，向上取整为 2 的幂）
+    OverflowPolicy overflow_policy = OverflowPolicy::BLOCK;
+    bool use_io_uring = true;      // 写线程通过 io_uring 一次提交所有文件的写入，不可用时逐个文件 write
+    WaitStrategy wait_strategy = WaitStrategy::BLOCKING;
+    std::chrono::milliseconds max_wait = std::chrono::milliseconds(10);  // 写线程每次休眠的上限
+    ThreadOptions writer_thread;   // 写线程的 CPU 绑定和调度参数
+};
+
+// 单个模块的速率预算，0 表示不限制
+struct LogBudget {
+    uint64_t bytes_per_second = 0;    // 渲染后的日志字节数
+    uint64_t records_per_second = 0;
+    double burst_seconds = 1.0;       // 允许的突发，按速率计的秒数
+};
+
+// 过载保护配置（LogManager::setOverloadOptions）：磁盘或写线程跟不上时按级别丢弃记录，
+// 先丢 DEBUG，再丢 INFO，不低于 keep_level 的记录始终保留（队列满时仍按 overflow_policy 处理）
+struct OverloadOptions {
+    bool enabled = false;
+    // 异步队列占用达到容量的这一比例时丢弃 DEBUG / INFO（同步模式下没有队列，只有预算生效）
+    double shed_debug_fill = 0.5;
+    double shed_info_fill = 0.8;
+    LogLevel keep_level = LogLevel::WARN;
+    LogBudget budget;  // 每个模块的默认预算，超出时丢弃低于 keep_level 的记录
+    std::vector<std::pair<std::string, LogBudget>> module_budgets;  // 按模块名（glob）覆盖默认预算，后面的优先
+    // 每隔这段时间把各模块被丢弃的记录数汇总为一条 WARN 写入 LogOverload 模块
+    std::chrono::milliseconds summary_interval = std::chrono::milliseconds(5000);
+};
+
+// 日志管理器单例
+class LogManager {
+private:
+    std::map<std::string, std::shared_ptr<FileLogger>> loggers_;
+    std::map<std::string, std::unique_ptr<LogModule>> modules_;
+    StringIndex<LogModule*> module_index_;  // 按名称无锁查找已有模块，新模块在 mutex_ 内插入
+    std::shared_ptr<FileLogger> summary_logger_;  // 汇总日志记录器
+    std::shared_ptr<LogSink> summary_sink_;       // 写入汇总日志的输出目标，默认即 summary_logger_
+    std::shared_ptr<SharedMemorySink> shm_sink_;  // LOG_TRANSPORT=shm 时的共享内存输出目标
+    std::vector<std::shared_ptr<LogSink>> global_sinks_;  // 订阅所有模块的输出目标（默认只有汇总日志）
+    std::vector<std::shared_ptr<LogSink>> all_sinks_;     // 所有注册过的输出目标，用于刷新
+    std::set<std::string> interned_strings_;
+    StringIndex<const char*> interned_index_;
+    std::mutex mutex_;
+    std::string base_log_dir_;
+    mutable std::once_flag log_dir_created_;
+    bool initialized_;
+
+    // 异步模式：生产者写入队列，后台线程负责落盘
+    std::unique_ptr<BoundedQueue<LogRecord>> queue_;
+    AsyncOptions async_options_;
+    std::atomic<bool> async_enabled_;
+    std::atomic<bool> writer_running_;
+    std::atomic<bool> writer_waiting_;
+    std::atomic<uint64_t> dropped_records_;
+    // 已确认处于异步模式、正在写入队列的生产者数，disableAsync 等待其归零后才停止写线程
+    alignas(kCacheLineSize) std::atomic<int> async_producers_{0};
+    std::atomic<int> min_level_;  // 运行时全局最低级别，没有匹配规则的模块使用该级别
+    // 格式化之前首先检查的级别：全局级别、各模块级别规则与飞行记录器级别中的最低者
+    std::atomic<int> capture_level_;
+    std::vector<std::pair<std::string, LogLevel>> level_rules_;  // 模块级别规则（glob），后添加的优先
+    std::thread writer_thread_;
+    std::mutex writer_mutex_;
+    std::condition_variable writer_cv_;
+    InlineMessageBuffer<kLogRecordMessageSize> format_buffer_;  // 写线程的延迟格式化缓冲区
+    std::string line_buffer_;   // 写线程的渲染缓冲区
+    std::mutex drain_mutex_;    // 写线程处理一批记录期间持有
+
+    RotationOptions rotation_options_;
+    LogIndexOptions index_options_;
+
+    // 过载保护：快速路径只读取这些原子变量，overload_options_ 在 mutex_ 内修改
+    OverloadOptions overload_options_;
+    std::atomic<bool> overload_enabled_{false};
+    std::atomic<int> overload_keep_level_{static_cast<int>(LogLevel::WARN)};
+    std::atomic<int> shed_permille_[2] = {};  // DEBUG / INFO 开始丢弃时的队列占用（千分比）
+    std::atomic<int64_t> overload_interval_ns_{0};
+    std::atomic<LogModule*> overload_module_{nullptr};  // 写入汇总的模块
+    ThrottleLimiter overload_report_limiter_;
+    std::mutex overload_mutex_;                 // 汇总丢弃数期间持有，可在 mutex_ 内获取
+    std::vector<LogModule*> overload_modules_;  // 所有模块，在 mutex_ 和 overload_mutex_ 内追加
+    int64_t overload_reported_ns_ = 0;
+
+    std::unique_ptr<FlightRecorder> flight_recorder_;
+    std::atomic<FlightRecorder*> active_recorder_;
+
+    // 级别配置文件监视线程
+    std::string level_config_path_;
+    std::thread level_watch_thread_;
+    std::mutex level_watch_mutex_;
+    std::condition_variable level_watch_cv_;
+    bool level_watch_running_ = false;
+
+    // 刷新策略及 INTERVAL 策略的定时线程
+    FlushOptions flush_options_;
+    std::thread flush_timer_thread_;
+    std::mutex flush_timer_mutex_;
+    std::condition_variable flush_timer_cv_;
+    bool flush_timer_running_ = false;
+
+    LogManager()
+        : initialized_(false), async_enabled_(false), writer_running_(false),
+          writer_waiting_(false), dropped_records_(0),
+          min_level_(static_cast<int>(LogLevel::DEBUG)),
+          capture_level_(static_cast<int>(LogLevel::DEBUG)), active_recorder_(nullptr) {
+        // 先构造跟踪器，使其在 LogManager 析构（导出跟踪）之后才析构
+        TraceRecorder::getInstance();
+        initializeLogDirectory();
+    }
+
+    // 程序退出时的导出状态（静态存储，LogManager 析构后仍可访问）
+    static inline bool exit_exported_ = false;
+    static inline bool destroyed_ = false;
+
+    ~LogManager() {
+        disableAsync();
+        stopFlushTimer();
+        stopLevelWatch();
+        if (!exit_exported_) {
+            exit_exported_ = true;
+            exportLogs();
+        }
+        destroyed_ = true;
+    }
+
+    void ensureLogDirectory() const {
+        std::call_once(log_dir_created_, [this] {
+            if (!createDirectories(base_log_dir_)) {
+                std::cerr << "Error: Cannot create log directory: " << base_log_dir_ << std::endl;
+            }
+        });
+    }
+
+    void initializeLogDirectory() {
+        // 尝试从环境变量获取日志目录
+        const char* log_dir_env = std::getenv("LOG_DIR");
+        if (log_dir_env) {
+            base_log_dir_ = std::string(log_dir_env);
+        } else {
+            // 如果没有环境变量，使用默认路径
+            const char* workspace = std::getenv("ROS_WORKSPACE");
+            if (workspace) {
+                base_log_dir_ = std::string(workspace) + "/logs/current";
+            } else {
+                base_log_dir_ = "/tmp/two_stage_int_logs";
+            }
+        }
+
+        // 日志目录和文件都在第一次写入时才创建，构造时不访问文件系统
+
+        // LOG_TRANSPORT=shm 时写入共享内存，由 log_collector 生成汇总日志和模块日志
+        const char* transport_env = std::getenv("LOG_TRANSPORT");
+        if (transport_env && std::strcmp(transport_env, "shm") == 0) {
+            // 共享内存的名称由目录的绝对路径计算，需要目录已经存在
+            ensureLogDirectory();
+            const char* size_env = std::getenv("LOG_SHM_SIZE");
+            size_t capacity = size_env ? std::strtoull(size_env, nullptr, 10) : 0;
+            shm_sink_ = std::make_shared<SharedMemorySink>(
+                base_log_dir_, capacity > 0 ? capacity : kDefaultShmRingSize);
+            if (shm_sink_->isOpen()) {
+                summary_sink_ = shm_sink_;
+                global_sinks_.push_back(shm_sink_);
+                all_sinks_.push_back(shm_sink_);
+            } else {
+                std::cerr << "Error: Cannot create shared memory log buffer, falling back to files" << std::endl;
+                shm_sink_.reset();
+            }
+        }
+
+        // 初始化汇总日志记录器
+        if (!shm_sink_) {
+            std::string summary_log_path = base_log_dir_ + "/ALL_LOGS_SUMMARY.log";
+            summary_logger_ = std::make_shared<FileLogger>(summary_log_path, LogLevel::DEBUG);
+            summary_sink_ = summary_logger_;
+            global_sinks_.push_back(summary_logger_);
+            all_sinks_.push_back(summary_logger_);
+        }
+
+        initialized_ = true;
+
+        // 启动时的模块级别，如 LOG_LEVELS="INFO,Planner*=DEBUG"；LOG_LEVEL_CONFIG 指定要监视的配置文件
+        const char* levels_env = std::getenv("LOG_LEVELS");
+        if (levels_env) {
+            applyLevelConfigLocked(levels_env);
+        }
+        const char* config_env = std::getenv("LOG_LEVEL_CONFIG");
+        if (config_env) {
+            level_config_path_ = config_env;
+            loadLevelConfigLocked();
+            level_watch_running_ = true;
+            level_watch_thread_ = std::thread(&LogManager::levelWatchLoop, this,
+                                              std::chrono::milliseconds(1000));
+        }
+    }
+
+public:
+    static LogManager& getInstance() {
+        static LogManager instance;
+        return instance;
+    }
+
+    // 程序结束时导出一次日志；LogManager 可能先于导出器析构，此时由其析构函数完成导出
+    static void exportAtExit() {
+        if (destroyed_ || exit_exported_) {
+            return;
+        }
+        exit_exported_ = true;
+        getInstance().exportLogs();
+    }
+
+    // 禁止拷贝和赋值
+    LogManager(const LogManager&) = delete;
+    LogManager& operator=(const LogManager&) = delete;
+
+    // 获取模块的日志文件（模块不存在则创建），模块已存在时不加锁
+    std::shared_ptr<FileLogger> getLogger(std::string_view module_name) {
+        return getModule(module_name)->fileLogger();
+    }
+
+    // 同上，并把该文件接收的最低级别设为 min_level；模块已存在（如先被 LOG 或 addSink 创建）时同样生效，
+    // 与 FileLogger::setMinLevel 相同
+    std::shared_ptr<FileLogger> getLogger(std::string_view module_name, LogLevel min_level) {
+        LogModule* module = module_index_.find(module_name);
+        if (!module) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            module = getModuleLocked(std::string(module_name), min_level);
+        }
+        const std::shared_ptr<FileLogger>& logger = module->fileLogger();
+        if (logger) {
+            logger->setMinLevel(min_level);
+        }
+        return logger;
+    }
+
+    // 获取模块（不存在则创建），返回的指针在 LogManager 生命周期内有效；模块已存在时不加锁
+    LogModule* getModule(std::string_view module_name) {
+        if (LogModule* module = module_index_.find(module_name)) {
+            return module;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        return getModuleLocked(std::string(module_name), LogLevel::DEBUG);
+    }
+
+    // 查找已有模块，不存在时返回空（不创建模块，不加锁）
+    LogModule* findModule(std::string_view module_name) const {
+        return module_index_.find(module_name);
+    }
+
+    // 为单个模块添加输出目标，该模块的日志会同时写入其中
+    void addSink(const std::string& module_name, std::shared_ptr<LogSink> sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        LogModule* module = getModuleLocked(module_name, LogLevel::DEBUG);
+        sink->setFlushOptions(flush_options_);
+        module->extra_sinks_.push_back(sink);
+        all_sinks_.push_back(sink);
+        module->publishSinks(global_sinks_);
+    }
+
+    // 添加订阅所有模块的输出目标（与汇总日志相同）
+    void addGlobalSink(std::shared_ptr<LogSink> sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sink->setFlushOptions(flush_options_);
+        global_sinks_.push_back(sink);
+        all_sinks_.push_back(sink);
+        for (auto& pair : modules_) {
+            pair.second->publishSinks(global_sinks_);
+        }
+    }
+
+    // 移除输出目标；对象保留到 LogManager 销毁，正在写入的线程不受影响
+    void removeSink(const std::shared_ptr<LogSink>& sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        global_sinks_.erase(std::remove(global_sinks_.begin(), global_sinks_.end(), sink),
+                            global_sinks_.end());
+        for (auto& pair : modules_) {
+            auto& extra = pair.second->extra_sinks_;
+            extra.erase(std::remove(extra.begin(), extra.end(), sink), extra.end());
+            pair.second->publishSinks(global_sinks_);
+        }
+    }
+
+    // 替换汇总日志的输出目标（如按 CPU 分片写入的 ShardedSummarySink），汇总日志文件本身仍由
+    // getSummaryLogger() 管理，刷新和轮转策略照常生效
+    void setSummarySink(std::shared_ptr<LogSink> sink) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sink->setFlushOptions(flush_options_);
+        std::replace(global_sinks_.begin(), global_sinks_.end(), summary_sink_, sink);
+        summary_sink_ = sink;
+        all_sinks_.push_back(sink);
+        for (auto& pair : modules_) {
+            pair.second->publishSinks(global_sinks_);
+        }
+    }
+
+    // 设置运行时全局最低级别，没有匹配级别规则的模块低于该级别的 LOG 调用不会格式化消息
+    // （飞行记录器需要的级别除外）
+    void setMinLevel(LogLevel level) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        min_level_.store(static_cast<int>(level), std::memory_order_relaxed);
+        refreshLevelsLocked();
+    }
+
+    LogLevel getMinLevel() const {
+        return static_cast<LogLevel>(min_level_.load(std::memory_order_relaxed));
+    }
+
+    // 是否有任何模块或飞行记录器需要该级别，LOG 宏在查找调用处之前先做这一检查
+    bool isLevelEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= capture_level_.load(std::memory_order_relaxed);
+    }
+
+    // 设置模块级别规则，pattern 为模块名或 glob（如 "Planner*"），对已有和之后创建的模块立即生效
+    // 多条规则匹配同一模块时以最后设置的为准；相同 pattern 的规则会被替换
+    void setModuleLevel(const std::string& pattern, LogLevel level) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        setModuleLevelLocked(pattern, level);
+        refreshLevelsLocked();
+    }
+
+    // 删除模块级别规则，匹配的模块恢复使用其他规则或全局级别
+    void clearModuleLevel(const std::string& pattern) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        level_rules_.erase(std::remove_if(level_rules_.begin(), level_rules_.end(),
+                                          [&](const std::pair<std::string, LogLevel>& rule) {
+                                              return rule.first == pattern;
+                                          }),
+                           level_rules_.end());
+        refreshLevelsLocked();
+    }
+
+    // 模块当前生效的最低级别
+    LogLevel getModuleLevel(const std::string& module_name) {
+        if (LogModule* module = module_index_.find(module_name)) {
+            return module->level();
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = modules_.find(module_name);
+        return it != modules_.end() ? it->second->level() : resolveLevelLocked(module_name);
+    }
+
+    // 按文本配置替换全部级别设置，条目以换行或逗号分隔，# 之后为注释：
+    //   INFO              全局最低级别
+    //   Planner* = DEBUG  模块级别规则
+    // 任一条目无法解析时不做任何修改并返回 false
+    bool applyLevelConfig(const std::string& config) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return applyLevelConfigLocked(config);
+    }
+
+    // 监视级别配置文件，文件修改后按 applyLevelConfig 的格式重新加载（修改时间轮询）
+    void watchLevelConfig(const std::string& path,
+                          std::chrono::milliseconds interval = std::chrono::milliseconds(1000)) {
+        stopLevelWatch();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            level_config_path_ = path;
+            loadLevelConfigLocked();
+        }
+        {
+            std::lock_guard<std::mutex> watch_lock(level_watch_mutex_);
+            level_watch_running_ = true;
+        }
+        level_watch_thread_ = std::thread(&LogManager::levelWatchLoop, this, interval);
+    }
+
+    // 启用飞行记录器：在内存中保留最近的记录（可以包含不写入文件的 DEBUG），
+    // 崩溃时转储到 LOG_DIR/FLIGHT_RECORDER_<pid>.log。重复调用返回已有的记录器
+    FlightRecorder* enableFlightRecorder(const FlightRecorderOptions& options = FlightRecorderOptions()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!flight_recorder_) {
+            // 崩溃时在信号处理函数中直接打开转储文件，目录需要事先创建
+            ensureLogDirectory();
+            std::string path = base_log_dir_ + "/FLIGHT_RECORDER_" + std::to_string(::getpid()) + ".log";
+            flight_recorder_.reset(new FlightRecorder(options, path));
+            if (options.install_handlers) {
+                FlightRecorder::installCrashHandlers(flight_recorder_.get());
+            }
+            active_recorder_.store(flight_recorder_.get(), std::memory_order_release);
+            refreshLevelsLocked();
+        }
+        return flight_recorder_.get();
+    }
+
+    // 已启用的飞行记录器，未启用时为空
+    FlightRecorder* flightRecorder() const {
+        return active_recorder_.load(std::memory_order_acquire);
+    }
+
+    // 立即把飞行记录器的内容写入转储文件（例如检测到异常状态时）
+    bool dumpFlightRecorder(const char* reason = "manual") {
+        FlightRecorder* recorder = flightRecorder();
+        return recorder && recorder->dump(reason);
+    }
+
+    // 开始记录 LOG_SCOPE_TIMER 和 LOG_TRACE_* 的跟踪事件（计时器的统计不受影响，始终记录）
+    // export_at_exit 时在 exportLogs 中导出到 LOG_DIR/TRACE_<pid>.json
+    void enableTracing(const TraceOptions& options = TraceOptions()) {
+        TraceRecorder::getInstance().enable(options);
+    }
+
+    void disableTracing() {
+        TraceRecorder::getInstance().disable();
+    }
+
+    // 把各线程缓冲区中的跟踪事件导出为 Chrome trace 格式，path 为空时写入 LOG_DIR/TRACE_<pid>.json
+    // 返回写入的路径，失败时返回空字符串
+    std::string exportTrace(const std::string& path = std::string()) const {
+        std::string target = path;
+        if (target.empty()) {
+            ensureLogDirectory();
+            target = base_log_dir_ + "/TRACE_" + std::to_string(::getpid()) + ".json";
+        }
+        if (!TraceRecorder::getInstance().exportChromeTrace(target)) {
+            std::cerr << "Error: Cannot write trace file: " << target << std::endl;
+            return std::string();
+        }
+        return target;
+    }
+
+    // 设置时间戳精度（毫秒或微秒），对所有日志文件生效
+    void setTimestampPrecision(TimestampPrecision precision) {
+        log_utils::setTimestampPrecision(precision);
+    }
+
+    // 启用异步模式：LOG 调用只把记录拷入队列，由后台线程写入模块日志和汇总日志
+    // 队列在首次启用时按 queue_capacity 创建，之后保持不变
+    void enableAsync(const AsyncOptions& options = AsyncOptions()) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (async_enabled_ || writer_thread_.joinable()) {
+            return;
+        }
+        async_options_ = options;
+        WriteBatch::getInstance().setUseIoUring(options.use_io_uring);
+        if (!queue_) {
+            queue_.reset(new BoundedQueue<LogRecord>(options.queue_capacity));
+        }
+        writer_running_ = true;
+        writer_thread_ = std::thread(&LogManager::writerLoop, this);
+        async_enabled_ = true;
+    }
+
+    // 设置轮转压缩线程的 CPU 绑定和调度参数（默认 nice 19）；线程已在运行时立即生效
+    void setBackgroundThreadOptions(const ThreadOptions& options) {
+        BackgroundWorker::getInstance().setThreadOptions(options);
+    }
+
+    // 关闭异步模式，写完队列中剩余的记录后回到同步写入
+    void disableAsync() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!async_enabled_) {
+                return;
+            }
+            async_enabled_ = false;
+        }
+        // 已通过 isAsync() 检查的生产者仍可能写入队列；等它们完成后写线程再处理最后一批，
+        // 之后到达的生产者看到异步模式已关闭，在调用线程内写出（见 push）
+        while (async_producers_.load() != 0) {
+            std::this_thread::yield();
+        }
+        {
+            std::lock_guard<std::mutex> lock(writer_mutex_);
+            writer_running_ = false;
+        }
+        writer_cv_.notify_one();
+        if (writer_thread_.joinable()) {
+            writer_thread_.join();
+        }
+        drainQueue();
+    }
+
+    bool isAsync() const {
+        return async_enabled_.load(std::memory_order_acquire);
+    }
+
+    // 因队列满而丢弃的记录数
+    uint64_t getDroppedCount() const {
+        return dropped_records_.load(std::memory_order_relaxed);
+    }
+
+    // 日志系统自身的统计快照：各模块与全局的记录数、丢弃数、字节数，刷新次数，
+    // 异步队列深度和写线程延迟，以及采样的生产者延迟分位数
+    LogStats getStats() {
+        LogStats stats;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& pair : modules_) {
+            const LogCounters& counters = pair.second->counters();
+            LogModuleStats module;
+            module.module = pair.first;
+            module.submitted = counters.submitted.load(std::memory_order_relaxed);
+            module.dropped_queue = counters.dropped_queue.load(std::memory_order_relaxed);
+            module.dropped_throttled = counters.dropped_throttled.load(std::memory_order_relaxed);
+            module.dropped_overload = counters.dropped_overload.load(std::memory_order_relaxed);
+            module.bytes = counters.bytes.load(std::memory_order_relaxed);
+            stats.submitted += module.submitted;
+            stats.dropped_queue += module.dropped_queue;
+            stats.dropped_throttled += module.dropped_throttled;
+            stats.dropped_overload += module.dropped_overload;
+            stats.bytes += module.bytes;
+            stats.modules.push_back(std::move(module));
+        }
+
+        const LogStatsRecorder& recorder = LogStatsRecorder::getInstance();
+        stats.bytes_written = recorder.bytes_written.load(std::memory_order_relaxed);
+        stats.flushes = recorder.flushes.load(std::memory_order_relaxed);
+        stats.queue_depth = queue_ ? queue_->sizeApprox() : 0;
+        stats.queue_high_water = recorder.queue_high_water.load(std::memory_order_relaxed);
+        stats.queue_capacity = queue_ ? queue_->capacity() : 0;
+        stats.writer_lag_ns = recorder.writer_lag_ns.load(std::memory_order_relaxed);
+        stats.writer_max_lag_ns = recorder.writer_max_lag_ns.load(std::memory_order_relaxed);
+        stats.realtime_violations = recorder.realtime_violations.load(std::memory_order_relaxed);
+        stats.latency_samples = recorder.producer_latency.count();
+        stats.latency_p50_ns = recorder.producer_latency.percentile(0.5);
+        stats.latency_p99_ns = recorder.producer_latency.percentile(0.99);
+        stats.latency_p999_ns = recorder.producer_latency.percentile(0.999);
+        stats.latency_max_ns = recorder.producer_latency.max();
+        return stats;
+    }
+
+    // 清零所有统计（getDroppedCount 的计数不受影响）
+    void resetStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& pair : modules_) {
+            pair.second->counters().reset();
+        }
+        LogStatsRecorder::getInstance().reset();
+    }
+
+    // 异步模式下将一条已格式化的记录放入队列，返回 false 表示记录被丢弃
+    // file 必须指向静态存储的字符串（如 __FILE__），记录中只保存指针
+    bool enqueue(LogModule* module, LogLevel level, const char* file, int line,
+                 const char* message, size_t message_size) {
+        auto now = std::chrono::system_clock::now();
+        return push(module, level, [&](LogRecord& record) {
+            fillRecordHeader(record, now, module, level, file, line);
+            fillMessage(record, message, message_size);
+        });
+    }
+
+    // 调用处版本：模块、级别、文件名和行号直接引用静态元数据
+    bool enqueue(const LogCallSite& site, const char* message, size_t message_size) {
+        auto now = std::chrono::system_clock::now();
+        return push(site.module, site.level, [&](LogRecord& record) {
+            fillRecordHeader(record, now, site);
+            fillMessage(record, message, message_size);
+        });
+    }
+
+    // 异步模式下直接在队列槽位内格式化消息，不经过任何中间缓冲区；超出槽位的消息扩展到堆上
+    // （实时线程中截断到槽位大小）
+    template<typename... Args>
+    bool enqueueFormatted(const LogCallSite& site, const char* format, const Args&... args) {
+        auto now = std::chrono::system_clock::now();
+        return push(site.module, site.level, [&](LogRecord& record) {
+            fillRecordHeader(record, now, site);
+            record.formatter = nullptr;
+            record.format = nullptr;
+            MessageBuffer message(record.message, sizeof(record.message),
+                                  isRealtimeThread() ? sizeof(record.message) : kMaxLogMessageSize);
+            formatTo(message, format, args...);
+            record.message_size = static_cast<uint32_t>(message.size());
+            record.overflow = message.release(record.message, sizeof(record.message)).release();
+        });
+    }
+
+    // 异步模式下只拷贝格式串指针和参数，格式化推迟到写线程
+    // format 必须具有静态存储期（字符串字面量），参数编码后不能超过 kLogRecordMessageSize
+    template<typename... Args>
+    bool enqueueDeferred(const LogCallSite& site, const char* format, const Args&... args) {
+        auto now = std::chrono::system_clock::now();
+        return push(site.module, site.level, [&](LogRecord& record) {
+            fillRecordHeader(record, now, site);
+            record.formatter = DeferredArgs<Args...>::formatter();
+            record.format = format;
+            record.message_size = static_cast<uint32_t>(DeferredArgs<Args...>::encode(record.message, args...));
+        });
+    }
+
+    // 驻留字符串，返回在 LogManager 生命周期内有效的指针（用于运行时传入的文件名）
+    const char* internString(const std::string& value) {
+        if (const char* interned = interned_index_.find(value)) {
+            return interned;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto inserted = interned_strings_.insert(value);
+        if (inserted.second) {
+            interned_index_.insert(*inserted.first, inserted.first->c_str());
+        }
+        return inserted.first->c_str();
+    }
+
+    void exportLogs() {
+        // 写出最后一个周期的丢弃汇总
+        reportOverload();
+        flush();
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        // 关闭所有日志文件以确保数据写入
+        for (auto& pair : loggers_) {
+            // FileLogger的析构函数会自动关闭文件
+        }
+
+        std::cout << "日志已导出到: " << base_log_dir_ << std::endl;
+
+        if (shm_sink_) {
+            std::cout << "  * 共享内存: /dev/shm" << shm_sink_->name() << "（由 log_collector 写入文件）"
+                      << std::endl;
+            if (shm_sink_->dropped() > 0) {
+                std::cout << "  ! 缓冲区满丢弃 " << shm_sink_->dropped() << " 条" << std::endl;
+            }
+        }
+
+        // 列出汇总日志文件
+        if (summary_logger_) {
+            std::cout << "  * 汇总日志: " << summary_logger_->getFilePath() << std::endl;
+        }
+
+        // 列出所有模块日志文件
+        for (const auto& pair : loggers_) {
+            std::cout << "  - " << pair.second->getFilePath() << std::endl;
+        }
+
+        TraceRecorder& tracer = TraceRecorder::getInstance();
+        if (tracer.enabled() && tracer.options().export_at_exit) {
+            std::string trace_path = exportTrace();
+            if (!trace_path.empty()) {
+                std::cout << "  * 跟踪: " << trace_path << std::endl;
+            }
+        }
+    }
+
+    // 日志目录，返回前确保目录已经创建（供在其中直接打开文件的输出目标使用）
+    const std::string& getLogDirectory() const {
+        ensureLogDirectory();
+        return base_log_dir_;
+    }
+
+    // 共享内存传输（LOG_TRANSPORT=shm）下汇总日志由收集器写入，返回空指针
+    std::shared_ptr<FileLogger> getSummaryLogger() {
+        return summary_logger_;
+    }
+
+    // 设置所有模块日志和汇总日志（包括之后创建的）的轮转策略
+    void setRotationOptions(const RotationOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        rotation_options_ = options;
+        if (summary_logger_) {
+            summary_logger_->setRotationOptions(options);
+        }
+        for (auto& pair : loggers_) {
+            pair.second->setRotationOptions(options);
+        }
+    }
+
+    // 为所有模块日志和汇总日志（包括之后创建的）建立稀疏索引，供 log_query 按时间、模块和级别查询
+    void setIndexOptions(const LogIndexOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        index_options_ = options;
+        if (summary_logger_) {
+            summary_logger_->setIndexOptions(options);
+        }
+        for (auto& pair : loggers_) {
+            pair.second->setIndexOptions(options);
+        }
+    }
+
+    // 过载保护：按队列占用和各模块的速率预算丢弃低级别记录，并定期汇总丢弃情况，
+    // 避免日志写入跟不上时阻塞控制循环。对已有的和之后创建的模块都生效
+    void setOverloadOptions(const OverloadOptions& options) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        overload_options_ = options;
+        if (options.enabled && !overload_module_.load(std::memory_order_relaxed)) {
+            overload_module_.store(getModuleLocked("LogOverload", LogLevel::DEBUG), std::memory_order_release);
+        }
+        for (auto& pair : modules_) {
+            configureBudgetLocked(*pair.second);
+        }
+        auto permille = [](double fill) {
+            return static_cast<int>(std::min(std::max(fill, 0.0), 1.0) * 1000.0);
+        };
+        shed_permille_[0].store(permille(options.shed_debug_fill), std::memory_order_relaxed);
+        shed_permille_[1].store(permille(options.shed_info_fill), std::memory_order_relaxed);
+        overload_keep_level_.store(static_cast<int>(options.keep_level), std::memory_order_relaxed);
+        overload_interval_ns_.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            options.summary_interval).count(), std::memory_order_relaxed);
+        // 第一次汇总在一个周期之后
+        overload_report_limiter_.allow(options.summary_interval);
+        {
+            std::lock_guard<std::mutex> overload_lock(overload_mutex_);
+            overload_reported_ns_ = steadyNanoseconds();
+        }
+        overload_enabled_.store(options.enabled, std::memory_order_release);
+    }
+
+    // 过载保护是否放行这条记录；被丢弃时计入模块的 dropped_overload
+    bool admitOverload(LogModule* module, LogLevel level) {
+        if (!overload_enabled_.load(std::memory_order_relaxed)) {
+            return true;
+        }
+        int64_t now = steadyNanoseconds();
+        int value = static_cast<int>(level);
+        if (value >= overload_keep_level_.load(std::memory_order_relaxed)) {
+            module->record_budget_.charge(1, now);
+            return true;
+        }
+        bool shed = false;
+        if (isAsync() && value <= static_cast<int>(LogLevel::INFO)) {
+            // 读取队列的头尾位置，这两个缓存行在入队时本来就要访问
+            size_t depth = queue_->sizeApprox();
+            shed = depth * 1000 >= static_cast<size_t>(shed_permille_[value].load(std::memory_order_relaxed)) *
+                                       queue_->capacity();
+        }
+        shed = shed || !module->byte_budget_.available(now) || !module->record_budget_.tryCharge(1, now);
+        if (!shed) {
+            return true;
+        }
+        module->counters().dropped_overload.fetch_add(1, std::memory_order_relaxed);
+        module->shed_levels_[value].fetch_add(1, std::memory_order_relaxed);
+        // 同步模式下没有写线程，由丢弃记录的线程按周期写出汇总
+        if (!isAsync() && !isRealtimeThread()) {
+            maybeReportOverload();
+        }
+        return false;
+    }
+
+    // 设置所有日志文件（包括之后创建的）的刷新策略
+    // INTERVAL 策略由后台定时线程按 flush_interval 周期刷新
+    void setFlushOptions(const FlushOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            flush_options_ = options;
+            for (auto& sink : all_sinks_) {
+                sink->setFlushOptions(options);
+            }
+        }
+        stopFlushTimer();
+        if (options.policy == FlushPolicy::INTERVAL) {
+            std::lock_guard<std::mutex> lock(flush_timer_mutex_);
+            flush_timer_running_ = true;
+            flush_timer_thread_ = std::thread(&LogManager::flushTimerLoop, this, options.flush_interval);
+        }
+    }
+
+    // 等待异步队列中已有的记录全部写出，并把所有日志文件的缓冲区写入磁盘
+    void flush() {
+        while (isAsync() && !queue_->emptyApprox()) {
+            wakeWriter();
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        // 等待写线程处理完已经取出的最后一批记录
+        { std::lock_guard<std::mutex> drain_lock(drain_mutex_); }
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (auto& sink : all_sinks_) {
+            sink->flush();
+        }
+    }
+
+private:
+    LogLevel resolveLevelLocked(const std::string& module_name) const {
+        for (auto it = level_rules_.rbegin(); it != level_rules_.rend(); ++it) {
+            if (::fnmatch(it->first.c_str(), module_name.c_str(), 0) == 0) {
+                return it->second;
+            }
+        }
+        return getMinLevel();
+    }
+
+    void setModuleLevelLocked(const std::string& pattern, LogLevel level) {
+        level_rules_.erase(std::remove_if(level_rules_.begin(), level_rules_.end(),
+                                          [&](const std::pair<std::string, LogLevel>& rule) {
+                                              return rule.first == pattern;
+                                          }),
+                           level_rules_.end());
+        level_rules_.emplace_back(pattern, level);
+    }
+
+    // 重新计算所有模块的生效级别和格式化前的检查级别
+    void refreshLevelsLocked() {
+        int capture = min_level_.load(std::memory_order_relaxed);
+        for (const auto& rule : level_rules_) {
+            capture = std::min(capture, static_cast<int>(rule.second));
+        }
+        if (flight_recorder_) {
+            capture = std::min(capture, static_cast<int>(flight_recorder_->level()));
+        }
+        // 先放宽总检查级别再调整模块级别，并发的 LOG 调用不会漏掉刚开启的模块
+        capture_level_.store(std::min(capture, capture_level_.load(std::memory_order_relaxed)),
+                             std::memory_order_relaxed);
+        for (auto& pair : modules_) {
+            pair.second->level_.store(static_cast<int>(resolveLevelLocked(pair.first)),
+                                      std::memory_order_relaxed);
+        }
+        capture_level_.store(capture, std::memory_order_relaxed);
+    }
+
+    bool applyLevelConfigLocked(const std::string& config) {
+        LogLevel global_level = getMinLevel();
+        std::vector<std::pair<std::string, LogLevel>> rules;
+        size_t begin = 0;
+        while (begin <= config.size()) {
+            size_t end = config.find_first_of(",\n", begin);
+            if (end == std::string::npos) {
+                end = config.size();
+            }
+            std::string entry = config.substr(begin, end - begin);
+            begin = end + 1;
+            size_t comment = entry.find('#');
+            if (comment != std::string::npos) {
+                entry.erase(comment);
+            }
+
+            size_t equal = entry.find('=');
+            std::string pattern = equal == std::string::npos ? "" : entry.substr(0, equal);
+            std::string level_name = equal == std::string::npos ? entry : entry.substr(equal + 1);
+            auto trim = [](std::string& value) {
+                size_t first = value.find_first_not_of(" \t\r");
+                size_t last = value.find_last_not_of(" \t\r");
+                value = first == std::string::npos ? "" : value.substr(first, last - first + 1);
+            };
+            trim(pattern);
+            trim(level_name);
+            if (pattern.empty() && level_name.empty()) {
+                continue;
+            }
+
+            LogLevel level;
+            if (!parseLogLevel(level_name, level) || (equal != std::string::npos && pattern.empty())) {
+                std::cerr << "Error: Invalid log level entry: " << entry << std::endl;
+                return false;
+            }
+            if (pattern.empty()) {
+                global_level = level;
+            } else {
+                rules.emplace_back(pattern, level);
+            }
+        }
+
+        min_level_.store(static_cast<int>(global_level), std::memory_order_relaxed);
+        level_rules_.clear();
+        for (const auto& rule : rules) {
+            setModuleLevelLocked(rule.first, rule.second);
+        }
+        refreshLevelsLocked();
+        return true;
+    }
+
+    // 读取并应用级别配置文件（调用方持有 mutex_）
+    void loadLevelConfigLocked() {
+        std::ifstream file(level_config_path_);
+        if (!file) {
+            return;
+        }
+        std::stringstream content;
+        content << file.rdbuf();
+        applyLevelConfigLocked(content.str());
+    }
+
+    void stopLevelWatch() {
+        {
+            std::lock_guard<std::mutex> lock(level_watch_mutex_);
+            level_watch_running_ = false;
+        }
+        level_watch_cv_.notify_one();
+        if (level_watch_thread_.joinable()) {
+            level_watch_thread_.join();
+        }
+    }
+
+    void levelWatchLoop(std::chrono::milliseconds interval) {
+        auto modifiedTime = [this](struct timespec& mtime) {
+            struct stat st;
+            if (::stat(level_config_path_.c_str(), &st) != 0) {
+                return false;
+            }
+            mtime = st.st_mtim;
+            return true;
+        };
+        struct timespec last_mtime = {0, 0};
+        modifiedTime(last_mtime);
+
+        std::unique_lock<std::mutex> watch_lock(level_watch_mutex_);
+        while (level_watch_running_) {
+            level_watch_cv_.wait_for(watch_lock, interval, [this] { return !level_watch_running_; });
+            struct timespec mtime;
+            if (!level_watch_running_ || !modifiedTime(mtime)) {
+                continue;
+            }
+            if (mtime.tv_sec != last_mtime.tv_sec || mtime.tv_nsec != last_mtime.tv_nsec) {
+                last_mtime = mtime;
+                // 不在持有 level_watch_mutex_ 时获取 mutex_，与 watchLevelConfig 的加锁顺序保持一致
+                watch_lock.unlock();
+                {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    loadLevelConfigLocked();
+                }
+                watch_lock.lock();
+            }
+        }
+    }
+
+    // 拷贝已格式化的消息，放不进槽位时另行分配
+    // 超出槽位的消息另行在堆上分配；实时线程中截断到槽位大小
+    static void fillMessage(LogRecord& record, const char* message, size_t message_size) {
+        record.formatter = nullptr;
+        record.format = nullptr;
+        message_size = std::min(message_size, isRealtimeThread() ? sizeof(record.message) : kMaxLogMessageSize);
+        char* out = record.message;
+        if (message_size > sizeof(record.message)) {
+            out = record.overflow = new char[message_size];
+        }
+        std::memcpy(out, message, message_size);
+        record.message_size = static_cast<uint32_t>(message_size);
+    }
+
+    static void fillRecordHeader(LogRecord& record, std::chrono::system_clock::time_point now,
+                                 LogModule* module, LogLevel level, const char* file, int line) {
+        record.timestamp = now;
+        record.module = module;
+        record.site = nullptr;
+        record.overflow = nullptr;
+        record.level = level;
+        record.line = line;
+        record.file = baseName(file);
+    }
+
+    static void fillRecordHeader(LogRecord& record, std::chrono::system_clock::time_point now,
+                                 const LogCallSite& site) {
+        record.timestamp = now;
+        record.module = site.module;
+        record.site = &site;
+        record.overflow = nullptr;
+        record.level = site.level;
+        record.line = site.line;
+        record.file = site.file;
+    }
+
+    LogModule* getModuleLocked(const std::string& module_name, LogLevel min_level) {
+        auto it = modules_.find(module_name);
+        if (it != modules_.end()) {
+            return it->second.get();
+        }
+
+        // 创建新的日志文件（共享内存传输下模块日志由收集器写入）
+        std::shared_ptr<FileLogger> logger;
+        if (!shm_sink_) {
+            logger = std::make_shared<FileLogger>(base_log_dir_ + "/" + module_name + ".log", min_level);
+        }
+        if (logger && logger->isOpen()) {
+            logger->setFlushOptions(flush_options_);
+            logger->setRotationOptions(rotation_options_);
+            logger->setIndexOptions(index_options_);
+            loggers_[module_name] = logger;
+            all_sinks_.push_back(logger);
+        } else {
+            logger.reset();
+        }
+
+        std::unique_ptr<LogModule> module(new LogModule(module_name, logger));
+        module->level_.store(static_cast<int>(resolveLevelLocked(module_name)), std::memory_order_relaxed);
+        module->publishSinks(global_sinks_);
+        LogModule* result = module.get();
+        configureBudgetLocked(*result);
+        {
+            std::lock_guard<std::mutex> overload_lock(overload_mutex_);
+            overload_modules_.push_back(result);
+        }
+        modules_[module_name] = std::move(module);
+        // 模块完整构造之后才对无锁查找可见
+        module_index_.insert(result->name(), result);
+        return result;
+    }
+
+    void configureBudgetLocked(LogModule& module) const {
+        LogBudget budget = overload_options_.budget;
+        for (auto it = overload_options_.module_budgets.rbegin(); it != overload_options_.module_budgets.rend(); ++it) {
+            if (::fnmatch(it->first.c_str(), module.name().c_str(), 0) == 0) {
+                budget = it->second;
+                break;
+            }
         }
+        bool enabled = overload_options_.enabled;
+        module.byte_budget_.configure(enabled ? budget.bytes_per_second : 0, budget.burst_seconds);
+        module.record_budget_.configure(enabled ? budget.records_per_second : 0, budget.burst_seconds);
     }
 
-    void log(LogLevel level, const std::string& module, const std::string& file,
-             int line, const std::string& message) {
-        if (level < min_level_ || !log_file_.is_open()) {
+    // 到了汇总周期时写出丢弃汇总（多个线程同时到期时只有一个写出）
+    void maybeReportOverload() {
+        if (!overload_enabled_.load(std::memory_order_relaxed) ||
+            !overload_report_limiter_.allow(std::chrono::nanoseconds(
+                overload_interval_ns_.load(std::memory_order_relaxed)))) {
             return;
         }
-
-        std::lock_guard<std::mutex> lock(mutex_);
-        log_file_ << "[" << getCurrentTimestamp() << "] "
-                  << "[" << logLevelToString(level) << "] "
-                  << "[" << module << "] "
-                  << getFileName(file) << ":" << line << " - "
-                  << message << std::endl;
-        log_file_.flush();  // 确保立即写入文件
+        reportOverload();
     }
 
-    bool isOpen() const {
-        return log_file_.is_open();
-    }
-
-    const std::string& getFilePath() const {
-        return log_file_path_;
+    // 把上次汇总以来各模块按级别的丢弃数写为一条 WARN，如
+    // "overload: shed 1240 records in the last 5.000s: Planner(DEBUG=1200 INFO=36) Perception(DEBUG=4)"
+    // 在调用线程内直接写出，不经过异步队列和过载保护（写线程在队列满时也能写出）
+    void reportOverload() {
+        LogModule* target = overload_module_.load(std::memory_order_acquire);
+        if (!target) {
+            return;
+        }
+        std::string detail;
+        uint64_t total = 0;
+        double seconds = 0.0;
+        {
+            std::lock_guard<std::mutex> overload_lock(overload_mutex_);
+            int64_t now = steadyNanoseconds();
+            seconds = overload_reported_ns_ ? static_cast<double>(now - overload_reported_ns_) / 1e9 : 0.0;
+            overload_reported_ns_ = now;
+            for (LogModule* module : overload_modules_) {
+                std::string levels;
+                for (int level = 0; level < kLogLevelCount; ++level) {
+                    uint64_t count = module->shed_levels_[level].load(std::memory_order_relaxed);
+                    uint64_t delta = count - module->shed_reported_[level];
+                    module->shed_reported_[level] = count;
+                    if (delta > 0) {
+                        levels += levels.empty() ? "" : " ";
+                        levels += logLevelToString(static_cast<LogLevel>(level)) + "=" + std::to_string(delta);
+                        total += delta;
+                    }
+                }
+                if (!levels.empty()) {
+                    detail += " " + module->name() + "(" + levels + ")";
+                }
+            }
+        }
+        if (total == 0) {
+            return;
+        }
+        char prefix[96];
+        if (seconds > 0.0) {
+            std::snprintf(prefix, sizeof(prefix), "overload: shed %llu records in the last %.3fs:",
+                          static_cast<unsigned long long>(total), seconds);
+        } else {
+            std::snprintf(prefix, sizeof(prefix), "overload: shed %llu records:",
+                          static_cast<unsigned long long>(total));
+        }
+        std::string message = prefix + detail;
+        auto now = std::chrono::system_clock::now();
+        char timestamp[kTimestampBufferSize];
+        formatTimestamp(now, timestamp);
+        std::string text;
+        renderLine(text, timestamp, LogLevel::WARN, target->name().c_str(), "log_utils.h", __LINE__,
+                   message.data(), message.size());
+        LogEntry entry{now, LogLevel::WARN, target->name().c_str(), "log_utils.h", __LINE__,
+                       message.data(), message.size(), text.data(), text.size(), nullptr, nullptr, nullptr,
+                       nullptr, 0};
+        target->counters().submitted.fetch_add(1, std::memory_order_relaxed);
+        target->dispatch(entry);
     }
-};
 
-// 日志管理器单例
-class LogManager {
-private:
-    std::map<std::string, std::shared_ptr<FileLogger>> loggers_;
-    std::shared_ptr<FileLogger> summary_logger_;  // 汇总日志记录器
-    std::mutex mutex_;
-    std::string base_log_dir_;
-    bool initialized_;
+    // 按溢出策略放入队列，返回 false 表示记录被丢弃
+    template<typename Fill>
+    bool push(LogModule* module, LogLevel level, Fill&& fill) {
+        module->counters().submitted.fetch_add(1, std::memory_order_relaxed);
+        if (!admitOverload(module, level)) {
+            return false;
+        }
+        bool realtime = isRealtimeThread();
+        // 先登记再确认异步模式（均为 seq_cst）：disableAsync 要么等到本次写入完成，要么本次看到异步已关闭
+        async_producers_.fetch_add(1);
+        if (async_enabled_.load()) {
+            bool pushed = pushQueue(module, realtime, fill);
+            async_producers_.fetch_sub(1, std::memory_order_release);
+            return pushed;
+        }
+        async_producers_.fetch_sub(1, std::memory_order_release);
 
-    LogManager() : initialized_(false) {
-        initializeLogDirectory();
+        // 调用方检查 isAsync() 之后异步模式被关闭，写线程可能已经退出：在调用线程内写出，
+        // 实时线程与同步模式下相同，丢弃该记录
+        if (realtime) {
+            noteRealtimeViolation();
+            dropped_records_.fetch_add(1, std::memory_order_relaxed);
+            module->counters().dropped_queue.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        while (!queue_->tryPush(fill)) {
+            drainQueue();
+        }
+        drainQueue();
+        return true;
     }
 
-    void initializeLogDirectory() {
-        // 尝试从环境变量获取日志目录
-        const char* log_dir_env = std::getenv("LOG_DIR");
-        if (log_dir_env) {
-            base_log_dir_ = std::string(log_dir_env);
-        } else {
-            // 如果没有环境变量，使用默认路径
-            const char* workspace = std::getenv("ROS_WORKSPACE");
-            if (workspace) {
-                base_log_dir_ = std::string(workspace) + "/logs/current";
-            } else {
-                base_log_dir_ = "/tmp/two_stage_int_logs";
+    template<typename Fill>
+    bool pushQueue(LogModule* module, bool realtime, Fill& fill) {
+        bool pushed = queue_->tryPush(fill);
+        // 实时线程不等待、不释放被挤出的记录，也不唤醒写线程（写线程最迟 max_wait 后自行醒来）
+        if (!pushed) {
+            atomicStoreMax(LogStatsRecorder::getInstance().queue_high_water, queue_->capacity());
+            switch (realtime ? OverflowPolicy::DROP_NEWEST : async_options_.overflow_policy) {
+                case OverflowPolicy::BLOCK:
+                    while (!(pushed = queue_->tryPush(fill))) {
+                        wakeWriter();
+                        std::this_thread::yield();
+                    }
+                    break;
+                case OverflowPolicy::DROP_NEWEST:
+                    dropped_records_.fetch_add(1, std::memory_order_relaxed);
+                    module->counters().dropped_queue.fetch_add(1, std::memory_order_relaxed);
+                    return false;
+                case OverflowPolicy::DROP_OLDEST:
+                    while (!(pushed = queue_->tryPush(fill))) {
+                        if (queue_->tryPop([](LogRecord& oldest) {
+                                oldest.module->counters().dropped_queue.fetch_add(1, std::memory_order_relaxed);
+                                delete[] oldest.overflow;
+                            })) {
+                            dropped_records_.fetch_add(1, std::memory_order_relaxed);
+                        }
+                    }
+                    break;
             }
         }
 
-        // 创建日志目录
-        std::string create_dir_cmd = "mkdir -p " + base_log_dir_;
-        system(create_dir_cmd.c_str());
-
-        // 初始化汇总日志记录器
-        std::string summary_log_path = base_log_dir_ + "/ALL_LOGS_SUMMARY.log";
-        summary_logger_ = std::make_shared<FileLogger>(summary_log_path, LogLevel::DEBUG);
-
-        initialized_ = true;
+        if (!realtime && writer_waiting_.load()) {
+            wakeWriter();
+        }
+        return true;
     }
 
-public:
-    static LogManager& getInstance() {
-        static LogManager instance;
-        return instance;
+    void wakeWriter() {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        writer_cv_.notify_one();
     }
 
-    // 禁止拷贝和赋值
-    LogManager(const LogManager&) = delete;
-    LogManager& operator=(const LogManager&) = delete;
-
-    std::shared_ptr<FileLogger> getLogger(const std::string& module_name,
-                                         LogLevel min_level = LogLevel::DEBUG) {
-        std::lock_guard<std::mutex> lock(mutex_);
-
-        auto it = loggers_.find(module_name);
-        if (it != loggers_.end()) {
-            return it->second;
+    void stopFlushTimer() {
+        {
+            std::lock_guard<std::mutex> lock(flush_timer_mutex_);
+            flush_timer_running_ = false;
         }
-
-        // 创建新的日志文件
-        std::string log_file_path = base_log_dir_ + "/" + module_name + ".log";
-        auto logger = std::make_shared<FileLogger>(log_file_path, min_level);
-
-        if (logger->isOpen()) {
-            loggers_[module_name] = logger;
-            return logger;
+        flush_timer_cv_.notify_one();
+        if (flush_timer_thread_.joinable()) {
+            flush_timer_thread_.join();
         }
-
-        return nullptr;
     }
 
-    void exportLogs() {
-        std::lock_guard<std::mutex> lock(mutex_);
+    void flushTimerLoop(std::chrono::milliseconds interval) {
+        std::unique_lock<std::mutex> timer_lock(flush_timer_mutex_);
+        while (flush_timer_running_) {
+            flush_timer_cv_.wait_for(timer_lock, interval, [this] { return !flush_timer_running_; });
+            auto now = std::chrono::steady_clock::now();
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& sink : all_sinks_) {
+                sink->flushIfDue(now);
+            }
+        }
+    }
 
-        // 关闭所有日志文件以确保数据写入
-        for (auto& pair : loggers_) {
-            // FileLogger的析构函数会自动关闭文件
+    // 写出队列中当前所有记录，返回写出的条数
+    size_t drainQueue() {
+        if (!queue_) {
+            return 0;
+        }
+        std::lock_guard<std::mutex> drain_lock(drain_mutex_);
+        LogStatsRecorder& stats = LogStatsRecorder::getInstance();
+        // 写线程每次醒来时的队列深度接近这段时间的峰值
+        atomicStoreMax(stats.queue_high_water, queue_->sizeApprox());
+        // 处理期间各文件的写入先登记到 WriteBatch，分批一次提交
+        WriteBatch& batch = WriteBatch::getInstance();
+        WriteBatch::active() = true;
+        size_t count = 0;
+        while (queue_->tryPop([&](LogRecord& record) {
+            auto lag = std::chrono::system_clock::now() - record.timestamp;
+            uint64_t lag_ns = lag.count() > 0 ? static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(lag).count()) : 0;
+            stats.writer_lag_ns.store(lag_ns, std::memory_order_relaxed);
+            atomicStoreMax(stats.writer_max_lag_ns, lag_ns);
+            const char* message = record.messageData();
+            size_t message_size = record.message_size;
+            if (record.formatter) {
+                format_buffer_.clear();
+                record.formatter->format(record.format, record.message, format_buffer_);
+                message = format_buffer_.data();
+                message_size = format_buffer_.size();
+            }
+            char timestamp[kTimestampBufferSize];
+            formatTimestamp(record.timestamp, timestamp);
+            const char* module_name = record.module->name().c_str();
+            line_buffer_.clear();
+            renderLine(line_buffer_, timestamp, record.level, module_name, record.file,
+                       record.line, message, message_size);
+            LogEntry entry{record.timestamp, record.level, module_name, record.file, record.line,
+                           message, message_size, line_buffer_.data(), line_buffer_.size(),
+                           record.site, record.formatter, record.format,
+                           record.formatter ? record.message : nullptr,
+                           record.formatter ? record.message_size : 0};
+            record.module->dispatch(entry);
+            delete[] record.overflow;
+            record.overflow = nullptr;
+        })) {
+            if (++count % kWriteBatchRecords == 0) {
+                batch.submit();
+            }
         }
+        batch.submit();
+        WriteBatch::active() = false;
+        return count;
+    }
 
-        std::cout << "日志已导出到: " << base_log_dir_ << std::endl;
+    static void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
 
-        // 列出汇总日志文件
-        if (summary_logger_) {
-            std::cout << "  * 汇总日志: " << summary_logger_->getFilePath() << std::endl;
-        }
+    // 队列为空时先轮询 kSpinRounds 次、让出 CPU kYieldRounds 次，仍为空再休眠（ADAPTIVE）
+    static constexpr int kSpinRounds = 2000;
+    static constexpr int kYieldRounds = 50;
 
-        // 列出所有模块日志文件
-        for (const auto& pair : loggers_) {
-            std::cout << "  - " << pair.second->getFilePath() << std::endl;
+    void writerLoop() {
+        const ThreadOptions& thread_options = async_options_.writer_thread;
+        if (!thread_options.cpus.empty() || thread_options.policy >= 0 || thread_options.nice != 0) {
+            applyThreadOptions(thread_options, "log_writer");
+        }
+        const WaitStrategy strategy = async_options_.wait_strategy;
+        int idle_rounds = 0;
+        while (true) {
+            maybeReportOverload();
+            if (drainQueue() > 0) {
+                idle_rounds = 0;
+                continue;
+            }
+            if (!writer_running_) {
+                break;
+            }
+            if (strategy == WaitStrategy::BUSY_POLL ||
+                (strategy == WaitStrategy::ADAPTIVE && idle_rounds < kSpinRounds + kYieldRounds)) {
+                if (strategy == WaitStrategy::BUSY_POLL || idle_rounds < kSpinRounds) {
+                    cpuRelax();
+                } else {
+                    std::this_thread::yield();
+                }
+                ++idle_rounds;
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(writer_mutex_);
+            if (!writer_running_) {
+                break;
+            }
+            writer_waiting_ = true;
+            writer_cv_.wait_for(lock, async_options_.max_wait, [this] {
+                return !writer_running_ || !queue_->emptyApprox();
+            });
+            writer_waiting_ = false;
         }
+        drainQueue();
     }
+};
 
-    const std::string& getLogDirectory() const {
-        return base_log_dir_;
+inline LogCallSite::LogCallSite(const char* module_name, LogLevel level, const char* file,
+                                int line, const char* format, const LogKvSchema* kv)
+    : module_name(module_name), level(level), file(file), line(line), format(format),
+      id(CallSiteRegistry::getInstance().add(this)),
+      module(LogManager::getInstance().getModule(module_name)), kv(kv) {
+    // 首次执行时注册调用处、查找模块都需要加锁，实时线程中的调用处应先在初始化阶段执行一次
+    if (isRealtimeThread()) {
+        noteRealtimeViolation();
     }
+}
 
-    std::shared_ptr<FileLogger> getSummaryLogger() {
-        return summary_logger_;
+inline bool LogCallSite::isEnabled() const {
+    if (module->isEnabled(level)) {
+        return true;
     }
-};
+    FlightRecorder* recorder = LogManager::getInstance().flightRecorder();
+    return recorder && recorder->accepts(level);
+}
 
 // 自动导出器（在程序结束时自动调用）
 class AutoLogExporter {
 public:
     ~AutoLogExporter() {
-        LogManager::getInstance().exportLogs();
+        LogManager::exportAtExit();
     }
 };
 
@@ -239,9 +2158,9 @@ std::string formatLogMessage(const ModuleType& module,
                            const char* format,
                            Args... args) {
     // 格式化用户消息
-    char buffer[1024];
-    std::snprintf(buffer, sizeof(buffer), format, args...);
-    return std::string(buffer);
+    InlineMessageBuffer<kLogRecordMessageSize> buffer;
+    formatTo(buffer, format, args...);
+    return std::string(buffer.data(), buffer.size());
 }
 
 // 简单字符串版本（不需要格式化参数）
@@ -253,23 +2172,456 @@ std::string formatLogMessage(const ModuleType& module,
     return std::string(message);
 }
 
-// 日志记录函数
+// 每个线程一份的暂存区：同步路径在这里格式化和渲染，稳态下不分配堆内存
+struct ThreadScratch {
+    InlineMessageBuffer<kLogRecordMessageSize> message;  // 超长消息扩展到堆上，之后保留复用
+    char args[kLogRecordMessageSize];  // LOG_KV 字段值的原始编码
+    std::string text;
+
+    ThreadScratch() {
+        text.reserve(kLogRecordMessageSize + 256);
+    }
+};
+
+inline ThreadScratch& threadScratch() {
+    thread_local ThreadScratch scratch;
+    return scratch;
+}
+
+// 把调用线程标记为实时线程（或取消标记），应在进入实时循环之前调用：
+// 这里预先构造日志系统的单例和线程级缓冲区，并把缓冲区的消息上限设为当前容量，
+// 之后实时线程中的日志调用不再分配内存，超长消息被截断
+inline void setRealtimeThread(bool realtime) {
+    LogManager::getInstance();
+    LogStatsRecorder::getInstance();
+    size_t limit = realtime ? kLogRecordMessageSize : kMaxLogMessageSize;
+    threadScratch().message.setLimit(std::max(limit, threadScratch().message.capacity()));
+    streamScratch().message.setLimit(std::max(limit, streamScratch().message.capacity()));
+    if (realtime && TraceRecorder::getInstance().enabled()) {
+        TraceRecorder::getInstance().threadBuffer();
+    }
+    realtimeThreadFlag() = realtime;
+}
+
+// 在作用域内把当前线程标记为实时线程，并统计作用域内的违规次数（用于测试）
+class ScopedRealtimeThread {
+private:
+    bool previous_;
+    uint64_t start_violations_;
+
+public:
+    ScopedRealtimeThread() : previous_(isRealtimeThread()), start_violations_(realtimeViolations()) {
+        setRealtimeThread(true);
+    }
+
+    ~ScopedRealtimeThread() {
+        setRealtimeThread(previous_);
+    }
+
+    ScopedRealtimeThread(const ScopedRealtimeThread&) = delete;
+    ScopedRealtimeThread& operator=(const ScopedRealtimeThread&) = delete;
+
+    uint64_t violations() const {
+        return realtimeViolations() - start_violations_;
+    }
+};
+
+// 在调用线程内渲染并分发一条日志；site 可以为空
+// formatter 非空时 args 为参数的原始编码（LOG_KV 的字段值），随记录交给输出目标
+inline void dispatchLog(LogModule* module, const LogCallSite* site, LogLevel level,
+                        const char* file_name, int line, const char* message, size_t message_size,
+                        const DeferredFormatter* formatter = nullptr, const char* args = nullptr,
+                        size_t args_size = 0) {
+    // 只渲染一次，模块日志、汇总日志等所有输出目标写入完全相同的内容
+    module->counters().submitted.fetch_add(1, std::memory_order_relaxed);
+    if (!LogManager::getInstance().admitOverload(module, level)) {
+        return;
+    }
+    auto now = std::chrono::system_clock::now();
+    char timestamp[kTimestampBufferSize];
+    formatTimestamp(now, timestamp);
+    const char* module_name = module->name().c_str();
+    std::string& text = threadScratch().text;
+    text.clear();
+    renderLine(text, timestamp, level, module_name, file_name, line, message, message_size);
+    LogEntry entry{now, level, module_name, file_name, line, message, message_size,
+                   text.data(), text.size(), site, formatter, formatter ? site->format : nullptr,
+                   args, args_size};
+    module->dispatch(entry);
+}
+
+// 日志记录函数（使用已解析的模块，不经过 LogManager 的互斥锁）
+// module 由调用处缓存，在 LogManager 生命周期内有效；file 必须指向静态存储的字符串（如 __FILE__）
+inline void writeLog(LogModule* module, LogLevel level, const char* file, int line,
+                     const char* message, size_t message_size) {
+    auto& manager = LogManager::getInstance();
+
+    FlightRecorder* recorder = manager.flightRecorder();
+    if (recorder && recorder->accepts(level)) {
+        recorder->record(std::chrono::system_clock::now(), level, module->name().c_str(),
+                         baseName(file), line, message, message_size);
+    }
+
+    // 异步模式下交给后台线程渲染并写入
+    if (manager.isAsync()) {
+        manager.enqueue(module, level, file, line, message, message_size);
+        return;
+    }
+    dispatchLog(module, nullptr, level, baseName(file), line, message, message_size);
+}
+
+// 写入飞行记录器，返回是否还需要写入输出目标
+// 低于模块级别、只因飞行记录器而格式化的记录不再写入输出目标
+inline bool recordFlight(FlightRecorder* recorder, const LogCallSite& site,
+                         const char* message, size_t message_size) {
+    if (recorder->accepts(site.level)) {
+        recorder->record(std::chrono::system_clock::now(), site.level, site.module->name().c_str(),
+                         site.file, site.line, message, message_size);
+    }
+    return site.module->isEnabled(site.level);
+}
+
+// 实时线程的日志只写入异步队列，也不写入飞行记录器（时间戳格式化每秒调用一次 localtime_r）；
+// 未启用异步模式时丢弃该调用并计为违规。返回 false 表示本次调用不再写出
+inline bool admitRealtime(LogManager& manager, const LogCallSite& site) {
+    if (!manager.isAsync()) {
+        noteRealtimeViolation();
+        return false;
+    }
+    // 飞行记录器降低了调用处的级别时，这里仍按模块自身的级别过滤
+    return site.module->isEnabled(site.level);
+}
+
+inline void writeLog(LogModule* module, LogLevel level, const char* file, int line,
+                     const std::string& message) {
+    writeLog(module, level, file, line, message.c_str(), message.size());
+}
+
+// 调用处版本（LOG / LOG_STREAM 宏使用）
+inline void writeLog(const LogCallSite& site, const char* message, size_t message_size) {
+    ProducerLatencySample latency;
+    auto& manager = LogManager::getInstance();
+    bool realtime = isRealtimeThread();
+    if (realtime && !admitRealtime(manager, site)) {
+        return;
+    }
+    FlightRecorder* recorder = realtime ? nullptr : manager.flightRecorder();
+    if (recorder && !recordFlight(recorder, site, message, message_size)) {
+        return;
+    }
+    if (manager.isAsync()) {
+        manager.enqueue(site, message, message_size);
+        return;
+    }
+    dispatchLog(site.module, &site, site.level, site.file, site.line, message, message_size);
+}
+
+// 日志记录函数（按模块名查找模块，文件名会被驻留）
 inline void writeLog(const std::string& module, LogLevel level,
                     const std::string& file, int line,
                     const std::string& message) {
     auto& manager = LogManager::getInstance();
+    writeLog(manager.getModule(module), level, manager.internString(file), line, message);
+}
+
+// 把每个计时器的统计（次数、平均、p50 / p99 上界和最大耗时，微秒）写入其模块的日志，
+// 可在周期任务中调用，之后调用 resetTimerStats() 开始新的统计周期
+inline void logTimerSummary(LogLevel level = LogLevel::INFO) {
+    auto& manager = LogManager::getInstance();
+    for (const TimerStats& stats : timerStats()) {
+        char message[256];
+        int size = std::snprintf(message, sizeof(message),
+                                 "timer %s: count=%llu mean=%.3fus p50<=%.3fus p99<=%.3fus max=%.3fus",
+                                 stats.name.c_str(), static_cast<unsigned long long>(stats.count),
+                                 static_cast<double>(stats.total_ns) / static_cast<double>(stats.count) / 1e3,
+                                 static_cast<double>(stats.p50_ns) / 1e3, static_cast<double>(stats.p99_ns) / 1e3,
+                                 static_cast<double>(stats.max_ns) / 1e3);
+        size_t length = std::min(static_cast<size_t>(std::max(size, 0)), sizeof(message) - 1);
+        writeLog(manager.getModule(stats.module), level, "trace.h", 0, message, length);
+    }
+}
+
+// 格式串是否为 const 字符数组；局部字符数组同样满足，调用处还要用 LOG_UTILS_IS_LITERAL 确认是字面量
+template<typename Format>
+struct IsStaticFormat {
+    using Type = typename std::remove_reference<Format>::type;
+    static constexpr bool value = std::is_array<Type>::value &&
+        std::is_same<typename std::remove_extent<Type>::type, const char>::value;
+};
+
+// printf 风格日志：异步模式下若格式串为字面量（调用处元数据记录了格式串）且参数都可按值拷贝，
+// 则推迟到写线程格式化，否则（运行时格式串、字符数组、不支持的参数类型）立即格式化后写入
+template<typename Format, typename... Args>
+inline void writeLogFormat(const LogCallSite& site, Format&& format, const Args&... args) {
+    using Deferred = DeferredArgs<typename ArgCaptureType<Args>::type...>;
+    ProducerLatencySample latency;
+    auto& manager = LogManager::getInstance();
+    bool realtime = isRealtimeThread();
+    if (realtime && !admitRealtime(manager, site)) {
+        return;
+    }
+
+    // 飞行记录器需要在调用线程内拿到格式化好的消息，此时不再推迟格式化
+    if (FlightRecorder* recorder = realtime ? nullptr : manager.flightRecorder()) {
+        MessageBuffer& message = threadScratch().message;
+        message.clear();
+        formatTo(message, format, args...);
+        if (!recordFlight(recorder, site, message.data(), message.size())) {
+            return;
+        }
+        if (manager.isAsync()) {
+            manager.enqueue(site, message.data(), message.size());
+        } else {
+            dispatchLog(site.module, &site, site.level, site.file, site.line, message.data(), message.size());
+        }
+        return;
+    }
+
+    if constexpr (sizeof...(Args) > 0 && IsStaticFormat<Format>::value && Deferred::kSupported) {
+        if (site.format && manager.isAsync() && Deferred::encodedSize(args...) <= kLogRecordMessageSize) {
+            manager.enqueueDeferred<typename ArgCaptureType<Args>::type...>(site, site.format, args...);
+            return;
+        }
+    }
+
+    if (manager.isAsync()) {
+        manager.enqueueFormatted(site, format, args...);
+        return;
+    }
+    MessageBuffer& message = threadScratch().message;
+    message.clear();
+    formatTo(message, format, args...);
+    dispatchLog(site.module, &site, site.level, site.file, site.line, message.data(), message.size());
+}
+
+// 限流宏拦截了该调用处的一次调用
+inline void noteThrottled(const LogCallSite& site) {
+    site.module->noteThrottled();
+}
+
+// LOG_COLLAPSE 使用：格式化后与该调用处上一条消息比较，连续重复的消息只计数不写入
+template<typename Format, typename... Args>
+inline void writeLogCollapsed(const LogCallSite& site, CollapseLimiter& limiter,
+                              std::chrono::nanoseconds period, Format&& format, const Args&... args) {
+    // 折叠状态由互斥锁保护，实时线程中丢弃该调用
+    if (isRealtimeThread()) {
+        noteRealtimeViolation();
+        return;
+    }
+    MessageBuffer& buffer = threadScratch().message;
+    buffer.clear();
+    formatTo(buffer, format, args...);
+    const char* message = buffer.data();
+    size_t message_size = buffer.size();
+    uint64_t repeats = 0;
+    bool emit = limiter.admit(message, message_size, period, repeats);
+    if (repeats > 0) {
+        char note[64];
+        int note_size = std::snprintf(note, sizeof(note), "last message repeated %llu times",
+                                      static_cast<unsigned long long>(repeats));
+        writeLog(site, note, static_cast<size_t>(note_size));
+    }
+    if (emit) {
+        writeLog(site, message, message_size);
+    } else {
+        noteThrottled(site);
+    }
+}
+
+// LOG_KV 的字段值：std::string 按 C 字符串保存，其他类型原样传递
+template<typename T>
+inline const T& kvValue(const T& value) {
+    return value;
+}
+
+inline const char* kvValue(const std::string& value) {
+    return value.c_str();
+}
+
+// 字段值保存时的类型及其类型代码，不支持的类型由 writeLogKvValues 在编译期报错
+template<typename T>
+struct KvValueType {
+    using type = typename ArgCaptureType<decltype(kvValue(std::declval<const T&>()))>::type;
+};
+
+template<typename T>
+constexpr char kvTypeCode() {
+    if constexpr (ArgCodec<T>::kSupported) {
+        return ArgCodec<T>::kTypeCode;
+    } else {
+        return '?';
+    }
+}
+
+// LOG_KV 调用处：字段名在首次执行时才能从参数中取得，字段描述和调用处元数据随之构造一次
+// 两者有意不释放：程序退出时异步写线程和输出目标仍可能引用它们（与 LOG 的静态调用处相同）
+class LogKvSite {
+private:
+    const char* module_name_;
+    LogLevel level_;
+    const char* file_;
+    int line_;
+    const char* event_;
+    std::once_flag once_;
+    std::atomic<const LogCallSite*> site_;
+
+    template<typename Tuple, size_t... I>
+    void build(const Tuple& pairs, std::index_sequence<I...>) {
+        LogKvSchema* schema = new LogKvSchema();
+        schema->event = event_;
+        schema->keys = {static_cast<const char*>(std::get<2 * I>(pairs))...};
+        schema->signature = {kvTypeCode<typename KvValueType<typename std::decay<
+            typename std::tuple_element<2 * I + 1, Tuple>::type>::type>::type>()...};
+        buildKvFormat(*schema);
+        site_.store(new LogCallSite(module_name_, level_, file_, line_, schema->format.c_str(), schema),
+                    std::memory_order_release);
+    }
+
+public:
+    LogKvSite(const char* module_name, LogLevel level, const char* file, int line, const char* event)
+        : module_name_(module_name), level_(level), file_(file), line_(line), event_(event),
+          site_(nullptr) {}
+
+    LogKvSite(const LogKvSite&) = delete;
+    LogKvSite& operator=(const LogKvSite&) = delete;
+
+    // 尚未构造调用处元数据（首次执行）或模块需要该级别时为 true，为 false 时不必求值字段
+    bool mayBeEnabled() const {
+        const LogCallSite* site = site_.load(std::memory_order_acquire);
+        return !site || site->isEnabled();
+    }
+
+    template<typename... Pairs>
+    const LogCallSite& resolve(const Pairs&... pairs) {
+        std::call_once(once_, [&] {
+            build(std::forward_as_tuple(pairs...), std::make_index_sequence<sizeof...(Pairs) / 2>());
+        });
+        return *site_.load(std::memory_order_acquire);
+    }
+};
+
+template<typename... Values>
+inline void writeLogKvValues(const LogCallSite& site, const Values&... values) {
+    using Deferred = DeferredArgs<typename ArgCaptureType<Values>::type...>;
+    static_assert(Deferred::kSupported,
+                  "LOG_KV values must be arithmetic, enum, pointer, C string or std::string");
+    if constexpr (sizeof...(Values) == 0) {
+        writeLog(site, site.kv->event, std::strlen(site.kv->event));
+        return;
+    }
+    ProducerLatencySample latency;
+    auto& manager = LogManager::getInstance();
+    bool realtime = isRealtimeThread();
+    if (realtime && !admitRealtime(manager, site)) {
+        return;
+    }
+    MessageBuffer& message = threadScratch().message;
+    message.clear();
+    bool formatted = false;
+
+    if (FlightRecorder* recorder = realtime ? nullptr : manager.flightRecorder()) {
+        formatTo(message, site.format, values...);
+        formatted = true;
+        if (!recordFlight(recorder, site, message.data(), message.size())) {
+            return;
+        }
+    }
+
+    // 字段值按原始编码保存，异步模式下与字面量格式串的 LOG 一样推迟到写线程格式化
+    size_t args_size = Deferred::encodedSize(values...);
+    if (manager.isAsync()) {
+        if (args_size <= kLogRecordMessageSize) {
+            manager.enqueueDeferred<typename ArgCaptureType<Values>::type...>(site, site.format, values...);
+        } else if (formatted) {
+            manager.enqueue(site, message.data(), message.size());
+        } else {
+            manager.enqueueFormatted(site, site.format, values...);
+        }
+        return;
+    }
 
-    // 写入模块专用日志
-    auto logger = manager.getLogger(module);
-    if (logger) {
-        logger->log(level, module, file, line, message);
+    if (!formatted) {
+        formatTo(message, site.format, values...);
     }
+    if (args_size <= kLogRecordMessageSize) {
+        char* args = threadScratch().args;
+        Deferred::encode(args, values...);
+        dispatchLog(site.module, &site, site.level, site.file, site.line, message.data(), message.size(),
+                    Deferred::formatter(), args, args_size);
+    } else {
+        dispatchLog(site.module, &site, site.level, site.file, site.line, message.data(), message.size());
+    }
+}
+
+template<typename Tuple, size_t... I>
+inline void writeLogKvPairs(const LogCallSite& site, const Tuple& pairs, std::index_sequence<I...>) {
+    writeLogKvValues(site, kvValue(std::get<2 * I + 1>(pairs))...);
+}
+
+// LOG_KV 使用：参数为交替的字段名（字面量）和字段值
+template<typename... Pairs>
+inline void writeLogKv(LogKvSite& kv_site, const Pairs&... pairs) {
+    static_assert(sizeof...(Pairs) % 2 == 0, "LOG_KV expects key, value pairs");
+    const LogCallSite& site = kv_site.resolve(pairs...);
+    if (!site.isEnabled()) {
+        return;
+    }
+    writeLogKvPairs(site, std::forward_as_tuple(pairs...), std::make_index_sequence<sizeof...(Pairs) / 2>());
+}
+
+// LOG_STREAM 中的 ros 时间类型：与 roscpp 的 operator<< 相同，写为 "秒.纳秒"（纳秒补足 9 位）
+inline void appendSeconds(LogStream& log, bool negative, long long sec, uint32_t nsec) {
+    char digits[24];
+    char* cursor = digits;
+    if (negative) {
+        *cursor++ = '-';
+    }
+    cursor = std::to_chars(cursor, digits + sizeof(digits), sec).ptr;
+    *cursor++ = '.';
+    for (int i = 8; i >= 0; --i) {
+        cursor[i] = static_cast<char>('0' + nsec % 10);
+        nsec /= 10;
+    }
+    log.write(digits, static_cast<size_t>(cursor + 9 - digits));
+}
+
+// 已切换到 std::ostream 时交给 roscpp 自身的 operator<<，使之前的操纵符对其生效
+template<typename Time>
+inline LogStream& appendTime(LogStream& log, const Time& time) {
+    if (log.streaming()) {
+        log.stream() << time;
+    } else {
+        appendSeconds(log, false, time.sec, time.nsec);
+    }
+    return log;
+}
 
-    // 同时写入汇总日志
-    auto summary_logger = manager.getSummaryLogger();
-    if (summary_logger) {
-        summary_logger->log(level, module, file, line, message);
+template<typename Duration>
+inline LogStream& appendDuration(LogStream& log, const Duration& duration) {
+    if (log.streaming()) {
+        log.stream() << duration;
+    } else if (duration.sec >= 0 || duration.nsec == 0) {
+        appendSeconds(log, false, duration.sec, duration.nsec);
+    } else {
+        appendSeconds(log, duration.sec == -1, duration.sec + 1, 1000000000u - duration.nsec);
     }
+    return log;
+}
+
+inline LogStream& operator<<(LogStream& log, const ros::Time& time) {
+    return appendTime(log, time);
+}
+
+inline LogStream& operator<<(LogStream& log, const ros::WallTime& time) {
+    return appendTime(log, time);
+}
+
+inline LogStream& operator<<(LogStream& log, const ros::Duration& duration) {
+    return appendDuration(log, duration);
+}
+
+inline LogStream& operator<<(LogStream& log, const ros::WallDuration& duration) {
+    return appendDuration(log, duration);
 }
 
 } // namespace log_utils
@@ -282,36 +2634,128 @@ namespace planner {
 // LOG_FILE 宏（与 LOG 相同，为了兼容性保留）
 #define LOG_FILE(module, level, format, ...) LOG(module, level, format, ##__VA_ARGS__)
 
+// 编译期最低日志级别（0=DEBUG 1=INFO 2=WARN 3=ERROR），低于该级别的日志调用会被编译器整体消除
+// 例如 -DLOG_UTILS_ACTIVE_LEVEL=1 可在发布版本中去掉所有 DEBUG 日志
+#ifndef LOG_UTILS_ACTIVE_LEVEL
+#define LOG_UTILS_ACTIVE_LEVEL 0
+#endif
+
+// 将级别记号（DEBUG/INFO/WARN/ERROR）在编译期映射为 LogLevel，未知记号直接编译报错
+#define LOG_UTILS_LEVEL(level) log_utils::LogLevel::level
+
+// 编译期级别判断在前，被裁掉的级别不会产生任何运行时代码；运行时先检查所有模块中最低的级别，
+// 再在调用处检查所属模块的级别，两者都在格式化之前
+#define LOG_UTILS_LEVEL_ENABLED(level) \
+    (static_cast<int>(LOG_UTILS_LEVEL(level)) >= LOG_UTILS_ACTIVE_LEVEL && \
+     log_utils::LogManager::getInstance().isLevelEnabled(LOG_UTILS_LEVEL(level)))
+
+// 格式串是否为字符串字面量：只有字面量在程序运行期间一直有效，局部字符数组在调用返回后即失效，
+// 不能记录到静态元数据中或推迟格式化。__builtin_constant_p 只对字面量为真且不求值参数，
+// 其他编译器按非字面量处理（全部立即格式化）
+#if defined(__GNUC__)
+#define LOG_UTILS_IS_LITERAL(format) __builtin_constant_p(format)
+#else
+#define LOG_UTILS_IS_LITERAL(format) false
+#endif
+
+// 调用处静态元数据：文件名在编译期截取，模块只在首次执行时查找一次，之后直接使用缓存的指针
+// 只有字面量格式串会记录到元数据中，其他格式串表达式不会被额外求值
+#define LOG_UTILS_CALL_SITE(module, level, format) \
+    static constexpr const char* __log_utils_file = log_utils::baseName(__FILE__); \
+    static const log_utils::LogCallSite __log_utils_site( \
+        #module, LOG_UTILS_LEVEL(level), __log_utils_file, __LINE__, \
+        log_utils::IsStaticFormat<decltype((format))>::value && LOG_UTILS_IS_LITERAL(format) ? \
+            log_utils::asStaticFormat(format) : nullptr)
+
 // 日志宏（仅输出到文件）
 #define LOG(module, level, format, ...) \
     do { \
-        const char* __module_str = #module; \
-        std::string __message = log_utils::formatLogMessage(__module_str, __FILE__, __LINE__, format, ##__VA_ARGS__); \
-        if (strcmp(#level, "INFO") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::INFO, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "WARN") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::WARN, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "ERROR") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::ERROR, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "DEBUG") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::DEBUG, __FILE__, __LINE__, __message); \
+        if (LOG_UTILS_LEVEL_ENABLED(level)) { \
+            LOG_UTILS_CALL_SITE(module, level, format); \
+            if (__log_utils_site.isEnabled()) { \
+                LOG_UTILS_CHECK_FORMAT(format, ##__VA_ARGS__); \
+                log_utils::writeLogFormat(__log_utils_site, format, ##__VA_ARGS__); \
+            } \
+        } \
+    } while(0)
+
+// 结构化日志：LOG_KV(Planner, INFO, "replan", "cost", cost, "iters", n)
+// 文本日志写为 "replan cost=1.5 iters=3"，JSON / 二进制日志保存带类型的字段
+#define LOG_KV(module, level, event, ...) \
+    do { \
+        if (LOG_UTILS_LEVEL_ENABLED(level)) { \
+            static constexpr const char* __log_utils_file = log_utils::baseName(__FILE__); \
+            static log_utils::LogKvSite __log_utils_kv(#module, LOG_UTILS_LEVEL(level), __log_utils_file, \
+                                                       __LINE__, event); \
+            if (__log_utils_kv.mayBeEnabled()) { \
+                log_utils::writeLogKv(__log_utils_kv, ##__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
 #define LOG_STREAM(module, level, stream) \
     do { \
-        const char* __module_str = #module; \
-        std::ostringstream __oss; \
-        __oss << stream; \
-        std::string __message = __oss.str(); \
-        if (strcmp(#level, "INFO") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::INFO, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "WARN") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::WARN, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "ERROR") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::ERROR, __FILE__, __LINE__, __message); \
-        } else if (strcmp(#level, "DEBUG") == 0) { \
-            log_utils::writeLog(__module_str, log_utils::LogLevel::DEBUG, __FILE__, __LINE__, __message); \
+        if (LOG_UTILS_LEVEL_ENABLED(level)) { \
+            LOG_UTILS_CALL_SITE(module, level, nullptr); \
+            if (__log_utils_site.isEnabled()) { \
+                log_utils::ScopedLogStream __log_utils_stream; \
+                __log_utils_stream.get() << stream; \
+                log_utils::writeLog(__log_utils_site, __log_utils_stream.data(), __log_utils_stream.size()); \
+            } \
+        } \
+    } while(0)
+
+// 限流日志宏：限流状态是调用处的静态变量，被拦截的调用不格式化、不求值参数，只计入模块的
+// dropped_throttled 统计
+#define LOG_UTILS_LIMITED(module, level, allowed, format, ...) \
+    do { \
+        if (LOG_UTILS_LEVEL_ENABLED(level)) { \
+            LOG_UTILS_CALL_SITE(module, level, format); \
+            if (__log_utils_site.isEnabled()) { \
+                if (allowed) { \
+                    LOG_UTILS_CHECK_FORMAT(format, ##__VA_ARGS__); \
+                    log_utils::writeLogFormat(__log_utils_site, format, ##__VA_ARGS__); \
+                } else { \
+                    log_utils::noteThrottled(__log_utils_site); \
+                } \
+            } \
+        } \
+    } while(0)
+
+// 每 n 次调用写一次（第 1、n+1、2n+1... 次）
+#define LOG_EVERY_N(module, level, n, format, ...) \
+    do { \
+        static log_utils::EveryNLimiter __log_utils_limiter; \
+        LOG_UTILS_LIMITED(module, level, __log_utils_limiter.allow(n), format, ##__VA_ARGS__); \
+    } while(0)
+
+// 每 period_ms 毫秒最多写一次
+#define LOG_THROTTLE(module, level, period_ms, format, ...) \
+    do { \
+        static log_utils::ThrottleLimiter __log_utils_limiter; \
+        LOG_UTILS_LIMITED(module, level, __log_utils_limiter.allow(std::chrono::milliseconds(period_ms)), \
+                          format, ##__VA_ARGS__); \
+    } while(0)
+
+// 只写第一次
+#define LOG_ONCE(module, level, format, ...) \
+    do { \
+        static log_utils::OnceLimiter __log_utils_limiter; \
+        LOG_UTILS_LIMITED(module, level, __log_utils_limiter.allow(), format, ##__VA_ARGS__); \
+    } while(0)
+
+// 折叠连续重复的消息，内容变化或距上次输出超过 period_ms 毫秒时写一条 "last message repeated K times"
+// 需要先格式化才能比较内容，开销与 LOG 相同，只是省掉了重复的写入
+#define LOG_COLLAPSE(module, level, period_ms, format, ...) \
+    do { \
+        if (LOG_UTILS_LEVEL_ENABLED(level)) { \
+            static log_utils::CollapseLimiter __log_utils_limiter; \
+            LOG_UTILS_CALL_SITE(module, level, format); \
+            if (__log_utils_site.isEnabled()) { \
+                LOG_UTILS_CHECK_FORMAT(format, ##__VA_ARGS__); \
+                log_utils::writeLogCollapsed(__log_utils_site, __log_utils_limiter, \
+                                             std::chrono::milliseconds(period_ms), format, ##__VA_ARGS__); \
+            } \
         } \
     } while(0)
 
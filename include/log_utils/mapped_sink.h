@@ -0,0 +1,211 @@
+#ifndef LOG_UTILS_MAPPED_SINK_H
+#define LOG_UTILS_MAPPED_SINK_H
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/log_utils.h"
+
+namespace log_utils {
+
+// 内存映射文件输出目标：预先分配固定大小的段文件并映射到内存，日志直接 memcpy 进映射区，
+// 写满后切换到下一个段。数据写入即进入页缓存，进程崩溃时不会丢失，不需要逐行刷新。
+// 段文件按 <名称>.<序号><扩展名> 命名（如 ALL_LOGS.0000.log），正常关闭时截断到实际长度；
+// 进程崩溃后文件末尾可能残留未使用的 '\0' 字节
+//
+// 刷新策略只决定何时调用 msync(MS_ASYNC) 触发回写：EVERY_RECORD 不额外调用，
+// ON_SEVERITY / EVERY_N_BYTES 按级别或字节数触发，INTERVAL 由 LogManager 的定时线程触发；
+// flush() 使用 MS_SYNC 等待数据落盘
+class MappedFileSink : public LogSink {
+private:
+    static constexpr size_t kMinSegmentSize = 64 * 1024;
+
+    std::string stem_;       // 段文件路径中序号之前的部分
+    std::string extension_;  // 段文件扩展名（含 '.'）
+    size_t segment_size_;
+    LogLevel min_level_;
+    std::mutex mutex_;
+    FlushOptions flush_options_;
+    std::chrono::steady_clock::time_point last_flush_;
+
+    unsigned segment_index_;
+    std::string segment_path_;
+    int fd_;
+    char* data_;
+    size_t offset_;         // 当前段已写入的字节数
+    size_t synced_offset_;  // 已提交回写的位置
+
+    static size_t pageSize() {
+        static const size_t size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+        return size;
+    }
+
+    std::string segmentPath(unsigned index) const {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), ".%04u", index);
+        return stem_ + suffix + extension_;
+    }
+
+    // 创建并映射下一个段，跳过已存在的文件（如上次运行留下的段）
+    bool openSegment() {
+        std::string path;
+        int fd = -1;
+        while (fd < 0) {
+            path = segmentPath(segment_index_++);
+            fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+            if (fd < 0 && errno != EEXIST) {
+                std::cerr << "Error: Cannot open log file: " << path << std::endl;
+                return false;
+            }
+        }
+
+        // 预先分配磁盘空间，避免写入映射区时因磁盘已满触发 SIGBUS
+        int err = ::posix_fallocate(fd, 0, static_cast<off_t>(segment_size_));
+        if (err != 0) {
+            std::cerr << "Error: Cannot allocate log file: " << path << ": "
+                      << std::strerror(err) << std::endl;
+            ::close(fd);
+            ::unlink(path.c_str());
+            return false;
+        }
+        void* data = ::mmap(nullptr, segment_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (data == MAP_FAILED) {
+            std::cerr << "Error: Cannot map log file: " << path << std::endl;
+            ::close(fd);
+            ::unlink(path.c_str());
+            return false;
+        }
+        ::madvise(data, segment_size_, MADV_SEQUENTIAL);
+
+        fd_ = fd;
+        data_ = static_cast<char*>(data);
+        offset_ = 0;
+        synced_offset_ = 0;
+        segment_path_ = path;
+        return true;
+    }
+
+    // 解除映射并把段文件截断到实际写入的长度
+    void closeSegment() {
+        if (!data_) {
+            return;
+        }
+        ::munmap(data_, segment_size_);
+        if (::ftruncate(fd_, static_cast<off_t>(offset_)) != 0) {
+            std::cerr << "Error: Cannot truncate log file: " << segment_path_ << std::endl;
+        }
+        ::close(fd_);
+        data_ = nullptr;
+        fd_ = -1;
+    }
+
+    // 对尚未提交的区间调用 msync（调用方持有 mutex_）
+    void syncLocked(int flags) {
+        if (data_ && offset_ > synced_offset_) {
+            size_t begin = synced_offset_ & ~(pageSize() - 1);
+            ::msync(data_ + begin, offset_ - begin, flags);
+            synced_offset_ = offset_;
+        }
+        last_flush_ = std::chrono::steady_clock::now();
+    }
+
+    bool shouldSync(LogLevel level) const {
+        switch (flush_options_.policy) {
+            case FlushPolicy::EVERY_RECORD:  return false;
+            case FlushPolicy::ON_SEVERITY:   return level >= flush_options_.flush_level;
+            case FlushPolicy::EVERY_N_BYTES: return offset_ - synced_offset_ >= flush_options_.flush_bytes;
+            case FlushPolicy::INTERVAL:      return false;
+        }
+        return false;
+    }
+
+public:
+    // file_path 决定段文件的命名，如 /tmp/logs/ALL_LOGS.log -> /tmp/logs/ALL_LOGS.0000.log
+    MappedFileSink(const std::string& file_path, size_t segment_size = 64 * 1024 * 1024,
+                   LogLevel min_level = LogLevel::DEBUG)
+        : segment_size_(std::max(segment_size, kMinSegmentSize)), min_level_(min_level),
+          last_flush_(std::chrono::steady_clock::now()), segment_index_(0),
+          fd_(-1), data_(nullptr), offset_(0), synced_offset_(0) {
+        size_t slash = file_path.find_last_of('/');
+        size_t dot = file_path.find_last_of('.');
+        if (dot != std::string::npos && (slash == std::string::npos || dot > slash)) {
+            stem_ = file_path.substr(0, dot);
+            extension_ = file_path.substr(dot);
+        } else {
+            stem_ = file_path;
+        }
+        segment_size_ = (segment_size_ + pageSize() - 1) & ~(pageSize() - 1);
+        openSegment();
+    }
+
+    ~MappedFileSink() override {
+        closeSegment();
+    }
+
+    MappedFileSink(const MappedFileSink&) = delete;
+    MappedFileSink& operator=(const MappedFileSink&) = delete;
+
+    bool accepts(LogLevel level) const override {
+        return level >= min_level_;
+    }
+
+    void write(const LogEntry& entry) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!data_) {
+            return;
+        }
+        size_t size = std::min(entry.text_size, segment_size_);
+        if (segment_size_ - offset_ < size) {
+            closeSegment();
+            if (!openSegment()) {
+                return;
+            }
+        }
+        std::memcpy(data_ + offset_, entry.text, size);
+        offset_ += size;
+        if (shouldSync(entry.level)) {
+            syncLocked(MS_ASYNC);
+        }
+    }
+
+    void setFlushOptions(const FlushOptions& options) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        flush_options_ = options;
+    }
+
+    // 等待当前段已写入的数据落盘（包括此前只提交了异步回写的部分）
+    void flush() override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        synced_offset_ = 0;
+        syncLocked(MS_SYNC);
+    }
+
+    void flushIfDue(std::chrono::steady_clock::time_point now) override {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (flush_options_.policy == FlushPolicy::INTERVAL &&
+            now - last_flush_ >= flush_options_.flush_interval) {
+            syncLocked(MS_ASYNC);
+        }
+    }
+
+    bool isOpen() const {
+        return data_ != nullptr;
+    }
+
+    // 当前正在写入的段文件路径
+    std::string getSegmentPath() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return segment_path_;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_MAPPED_SINK_H
@@ -0,0 +1,166 @@
+#ifndef LOG_UTILS_RATE_LIMIT_H
+#define LOG_UTILS_RATE_LIMIT_H
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+
+namespace log_utils {
+
+// 以下限流状态都作为调用处的函数内静态变量使用（见 LOG_EVERY_N 等宏），
+// 只有常量初始化的原子成员，不需要线程安全的静态初始化检查
+
+inline int64_t steadyNanoseconds() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 每 N 次调用放行一次（第 1、N+1、2N+1... 次）
+class EveryNLimiter {
+private:
+    std::atomic<uint64_t> count_{0};
+
+public:
+    bool allow(uint64_t n) {
+        return count_.fetch_add(1, std::memory_order_relaxed) % (n > 0 ? n : 1) == 0;
+    }
+};
+
+// 每个周期最多放行一次；被拦截的调用只读取时钟并做一次 relaxed load 和比较
+class ThrottleLimiter {
+private:
+    std::atomic<int64_t> next_ns_{std::numeric_limits<int64_t>::min()};
+
+public:
+    bool allow(std::chrono::nanoseconds period) {
+        int64_t now = steadyNanoseconds();
+        int64_t next = next_ns_.load(std::memory_order_relaxed);
+        if (now < next) {
+            return false;
+        }
+        // 多个线程同时到期时只有一个能放行
+        return next_ns_.compare_exchange_strong(next, now + period.count(), std::memory_order_relaxed);
+    }
+};
+
+// 只放行第一次调用
+class OnceLimiter {
+private:
+    std::atomic<bool> done_{false};
+
+public:
+    bool allow() {
+        return !done_.load(std::memory_order_relaxed) &&
+               !done_.exchange(true, std::memory_order_relaxed);
+    }
+};
+
+// 按速率计的预算（GCRA）：每消耗一个单位，理论到达时间推后 1/rate 秒，
+// 理论到达时间超前当前时间不超过 burst 时认为还有余量。只有一个原子状态，不加锁
+class RateBudget {
+private:
+    std::atomic<int64_t> tat_ns_{0};      // 理论到达时间
+    std::atomic<uint64_t> rate_{0};       // 每秒的单位数，0 表示不限制
+    std::atomic<int64_t> burst_ns_{0};
+
+    int64_t cost(uint64_t units, uint64_t rate) const {
+        return static_cast<int64_t>(units * 1000000000ULL / rate);
+    }
+
+public:
+    void configure(uint64_t rate_per_second, double burst_seconds) {
+        burst_ns_.store(static_cast<int64_t>(burst_seconds * 1e9), std::memory_order_relaxed);
+        rate_.store(rate_per_second, std::memory_order_relaxed);
+    }
+
+    bool limited() const {
+        return rate_.load(std::memory_order_relaxed) != 0;
+    }
+
+    // 是否还有余量（不消耗）
+    bool available(int64_t now_ns) const {
+        return !limited() ||
+               tat_ns_.load(std::memory_order_relaxed) - now_ns <= burst_ns_.load(std::memory_order_relaxed);
+    }
+
+    // 无条件消耗 units（用于事后才知道大小的消耗，如写出的字节数）
+    void charge(uint64_t units, int64_t now_ns) {
+        uint64_t rate = rate_.load(std::memory_order_relaxed);
+        if (rate == 0) {
+            return;
+        }
+        int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+        while (!tat_ns_.compare_exchange_weak(tat, std::max(tat, now_ns) + cost(units, rate),
+                                              std::memory_order_relaxed)) {
+        }
+    }
+
+    // 有余量时消耗 units 并返回 true
+    bool tryCharge(uint64_t units, int64_t now_ns) {
+        uint64_t rate = rate_.load(std::memory_order_relaxed);
+        if (rate == 0) {
+            return true;
+        }
+        int64_t burst = burst_ns_.load(std::memory_order_relaxed);
+        int64_t tat = tat_ns_.load(std::memory_order_relaxed);
+        do {
+            if (tat - now_ns > burst) {
+                return false;
+            }
+        } while (!tat_ns_.compare_exchange_weak(tat, std::max(tat, now_ns) + cost(units, rate),
+                                                std::memory_order_relaxed));
+        return true;
+    }
+};
+
+// 折叠连续重复的消息：同一调用处连续写出相同内容时只保留第一条，
+// 内容变化时（或距上次输出超过 period 时）补写一条 "last message repeated K times"
+class CollapseLimiter {
+private:
+    std::mutex mutex_;
+    uint64_t last_hash_ = 0;
+    bool has_last_ = false;
+    uint64_t repeats_ = 0;    // 尚未报告的重复次数
+    int64_t reported_ns_ = 0; // 上次输出（消息或重复汇总）的时间
+
+    static uint64_t hashMessage(const char* message, size_t size) {
+        uint64_t hash = 1469598103934665603ULL;  // FNV-1a
+        for (size_t i = 0; i < size; ++i) {
+            hash ^= static_cast<unsigned char>(message[i]);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+public:
+    // 返回是否写出本条消息；repeats 为需要先补写的重复次数（0 表示不需要）
+    bool admit(const char* message, size_t size, std::chrono::nanoseconds period, uint64_t& repeats) {
+        uint64_t hash = hashMessage(message, size);
+        int64_t now = steadyNanoseconds();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!has_last_ || hash != last_hash_) {
+            repeats = repeats_;
+            repeats_ = 0;
+            last_hash_ = hash;
+            has_last_ = true;
+            reported_ns_ = now;
+            return true;
+        }
+        ++repeats_;
+        repeats = 0;
+        if (period.count() > 0 && now - reported_ns_ >= period.count()) {
+            repeats = repeats_;
+            repeats_ = 0;
+            reported_ns_ = now;
+        }
+        return false;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_RATE_LIMIT_H
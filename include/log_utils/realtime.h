@@ -0,0 +1,45 @@
+#ifndef LOG_UTILS_REALTIME_H
+#define LOG_UTILS_REALTIME_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "log_utils/log_stats.h"
+
+// 实时线程的日志约束，不依赖 ROS
+//
+// 被 setRealtimeThread(true) 标记的线程中，LOG / LOG_STREAM / LOG_KV 只做格式化和无锁入队：
+// 不加锁、不分配内存、不进行系统调用。无法满足时（未启用异步模式、调用处首次执行、LOG_COLLAPSE 等）
+// 丢弃或照常执行该调用并计入 realtime_violations，测试中可据此核查实时线程的日志调用
+
+namespace log_utils {
+
+// 当前线程是否被标记为实时线程（平凡的 thread_local，访问时不触发线程局部对象的初始化）
+inline bool& realtimeThreadFlag() {
+    thread_local bool realtime = false;
+    return realtime;
+}
+
+inline bool isRealtimeThread() {
+    return realtimeThreadFlag();
+}
+
+inline uint64_t& realtimeViolationCounter() {
+    thread_local uint64_t violations = 0;
+    return violations;
+}
+
+// 实时线程中发生了一次违反约束的调用
+inline void noteRealtimeViolation() {
+    ++realtimeViolationCounter();
+    LogStatsRecorder::getInstance().realtime_violations.fetch_add(1, std::memory_order_relaxed);
+}
+
+// 当前线程累计的违规次数
+inline uint64_t realtimeViolations() {
+    return realtimeViolationCounter();
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_REALTIME_H
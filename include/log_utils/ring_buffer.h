@@ -0,0 +1,116 @@
+#ifndef LOG_UTILS_RING_BUFFER_H
+#define LOG_UTILS_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace log_utils {
+
+constexpr size_t kCacheLineSize = 64;
+
+// 有界无锁环形队列（Vyukov 算法），支持多生产者/多消费者
+// 每个槽位带一个序号，生产者和消费者通过 CAS 抢占位置，数据直接在槽位内读写
+template<typename T>
+class BoundedQueue {
+private:
+    struct alignas(kCacheLineSize) Cell {
+        std::atomic<size_t> sequence;
+        T data;
+    };
+
+    std::unique_ptr<Cell[]> cells_;
+    size_t mask_;
+    alignas(kCacheLineSize) std::atomic<size_t> enqueue_pos_;
+    alignas(kCacheLineSize) std::atomic<size_t> dequeue_pos_;
+
+    static size_t roundUpPowerOfTwo(size_t value) {
+        size_t result = 2;
+        while (result < value) {
+            result <<= 1;
+        }
+        return result;
+    }
+
+public:
+    // 容量向上取整为 2 的幂
+    explicit BoundedQueue(size_t capacity)
+        : cells_(new Cell[roundUpPowerOfTwo(capacity)]),
+          mask_(roundUpPowerOfTwo(capacity) - 1),
+          enqueue_pos_(0), dequeue_pos_(0) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    // 抢占一个空槽位并调用 fill(T&) 原地写入，队列已满时返回 false
+    template<typename Fill>
+    bool tryPush(Fill&& fill) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        fill(cell->data);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 取出最早的一个元素并调用 consume(T&) 原地处理，队列为空时返回 false
+    template<typename Consume>
+    bool tryPop(Consume&& consume) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        while (true) {
+            cell = &cells_[pos & mask_];
+            size_t seq = cell->sequence.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        consume(cell->data);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    size_t capacity() const {
+        return mask_ + 1;
+    }
+
+    // 近似元素个数（并发情况下仅供参考）
+    size_t sizeApprox() const {
+        size_t tail = enqueue_pos_.load(std::memory_order_acquire);
+        size_t head = dequeue_pos_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : 0;
+    }
+
+    bool emptyApprox() const {
+        return sizeApprox() == 0;
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_RING_BUFFER_H
@@ -0,0 +1,274 @@
+#ifndef LOG_UTILS_ROTATION_H
+#define LOG_UTILS_ROTATION_H
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "log_utils/log_index.h"
+#include "log_utils/thread_options.h"
+
+extern char** environ;
+
+namespace log_utils {
+
+// 轮转后文件的压缩方式（调用系统的 gzip / zstd 命令，命令不存在时保留未压缩文件）
+enum class Compression {
+    NONE = 0,
+    GZIP = 1,
+    ZSTD = 2
+};
+
+// 日志文件轮转配置，各项为 0 表示不限制
+struct RotationOptions {
+    size_t max_bytes = 0;                                  // 单个文件达到该大小后轮转
+    std::chrono::seconds max_age = std::chrono::seconds(0);  // 文件打开超过该时长后轮转
+    size_t max_files = 0;                                  // 每个日志文件最多保留的轮转文件数
+    Compression compression = Compression::GZIP;
+
+    bool enabled() const {
+        return max_bytes > 0 || max_age.count() > 0;
+    }
+};
+
+// 低优先级后台任务线程：日志轮转、压缩和清理都在这里执行，不占用日志线程
+// 线程在第一次提交任务时启动；进程退出时执行完剩余任务后结束
+class BackgroundWorker {
+private:
+    struct Task {
+        const void* owner;
+        std::function<void()> run;
+    };
+
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable done_cv_;
+    std::deque<Task> tasks_;
+    const void* running_owner_ = nullptr;
+    bool stopping_ = false;
+    std::thread thread_;
+    ThreadOptions options_;
+
+    BackgroundWorker() = default;
+
+    ~BackgroundWorker() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_one();
+        if (thread_.joinable()) {
+            thread_.join();
+        }
+    }
+
+    // 未指定 nice 值时降为 19；压缩进程继承本线程的 CPU 绑定、调度策略和 nice 值
+    static void applyOptions(ThreadOptions options) {
+        if (options.nice == 0) {
+            options.nice = 19;
+        }
+        applyThreadOptions(options, "log_background");
+    }
+
+    void loop() {
+        ThreadOptions options;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options = options_;
+        }
+        applyOptions(options);
+        std::unique_lock<std::mutex> lock(mutex_);
+        while (true) {
+            cv_.wait(lock, [this] { return stopping_ || !tasks_.empty(); });
+            if (tasks_.empty()) {
+                break;
+            }
+            Task task = std::move(tasks_.front());
+            tasks_.pop_front();
+            running_owner_ = task.owner;
+            lock.unlock();
+            task.run();
+            lock.lock();
+            running_owner_ = nullptr;
+            done_cv_.notify_all();
+        }
+    }
+
+public:
+    // 首次调用时构造；需要在后台提交任务的对象应在构造时调用一次，保证本实例晚于它们析构
+    static BackgroundWorker& getInstance() {
+        static BackgroundWorker instance;
+        return instance;
+    }
+
+    BackgroundWorker(const BackgroundWorker&) = delete;
+    BackgroundWorker& operator=(const BackgroundWorker&) = delete;
+
+    // 提交任务，owner 用于 cancel
+    void post(const void* owner, std::function<void()> run) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!thread_.joinable()) {
+                thread_ = std::thread(&BackgroundWorker::loop, this);
+            }
+            tasks_.push_back(Task{owner, std::move(run)});
+        }
+        cv_.notify_one();
+    }
+
+    // 设置本线程的 CPU 绑定和调度参数；线程已启动时在其中立即生效
+    void setThreadOptions(const ThreadOptions& options) {
+        bool running;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options_ = options;
+            running = thread_.joinable();
+        }
+        if (running) {
+            post(this, [options] { applyOptions(options); });
+        }
+    }
+
+    // 丢弃 owner 尚未执行的任务，并等待其正在执行的任务完成（owner 析构前调用）
+    void cancel(const void* owner) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        tasks_.erase(std::remove_if(tasks_.begin(), tasks_.end(),
+                                    [owner](const Task& task) { return task.owner == owner; }),
+                     tasks_.end());
+        done_cv_.wait(lock, [this, owner] { return running_owner_ != owner; });
+    }
+};
+
+// 把路径拆成目录、名称和扩展名（扩展名含 '.'），如 /tmp/logs/Planner.log -> /tmp/logs, Planner, .log
+inline void splitLogPath(const std::string& path, std::string& dir, std::string& stem,
+                         std::string& extension) {
+    size_t slash = path.find_last_of('/');
+    dir = slash == std::string::npos ? "." : path.substr(0, slash);
+    std::string name = slash == std::string::npos ? path : path.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    stem = dot == std::string::npos ? name : name.substr(0, dot);
+    extension = dot == std::string::npos ? "" : name.substr(dot);
+}
+
+// 逐级创建目录（与 mkdir -p 相同），目录已存在时同样返回 true
+inline bool createDirectories(const std::string& path) {
+    struct stat st;
+    if (path.empty()) {
+        return false;
+    }
+    if (::stat(path.c_str(), &st) == 0) {
+        return S_ISDIR(st.st_mode);
+    }
+    for (size_t slash = path.find('/', 1);; slash = path.find('/', slash + 1)) {
+        std::string prefix = path.substr(0, slash);
+        if (::mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+            return false;
+        }
+        if (slash == std::string::npos) {
+            return true;
+        }
+    }
+}
+
+// 轮转文件名：<名称>.<YYYYMMDD-HHMMSS>-<序号><扩展名>，按字典序即为时间顺序
+inline std::string rotatedFilePath(const std::string& path) {
+    std::string dir, stem, extension;
+    splitLogPath(path, dir, stem, extension);
+    std::time_t now = std::time(nullptr);
+    std::tm tm_value;
+    localtime_r(&now, &tm_value);
+    char stamp[32];
+    std::strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &tm_value);
+
+    for (unsigned seq = 0;; ++seq) {
+        char suffix[16];
+        std::snprintf(suffix, sizeof(suffix), "-%03u", seq);
+        std::string base = dir + "/" + stem + "." + stamp + suffix + extension;
+        struct stat st;
+        if (::stat(base.c_str(), &st) != 0 && ::stat((base + ".gz").c_str(), &st) != 0 &&
+            ::stat((base + ".zst").c_str(), &st) != 0) {
+            return base;
+        }
+    }
+}
+
+// 调用外部命令压缩文件，成功后删除原文件；命令不存在或失败时保留原文件
+inline void compressFile(const std::string& path, Compression compression) {
+    std::vector<const char*> argv;
+    switch (compression) {
+        case Compression::NONE:
+            return;
+        case Compression::GZIP:
+            argv = {"gzip", "-f", "-q", path.c_str(), nullptr};
+            break;
+        case Compression::ZSTD:
+            argv = {"zstd", "-f", "-q", "--rm", path.c_str(), nullptr};
+            break;
+    }
+    pid_t pid;
+    if (::posix_spawnp(&pid, argv[0], nullptr, nullptr, const_cast<char* const*>(argv.data()),
+                       environ) != 0) {
+        return;
+    }
+    int status;
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+}
+
+// 删除最旧的轮转文件，只保留最新的 max_files 个（连同其索引文件）
+inline void pruneRotatedFiles(const std::string& path, size_t max_files) {
+    if (max_files == 0) {
+        return;
+    }
+    std::string dir, stem, extension;
+    splitLogPath(path, dir, stem, extension);
+    std::string prefix = stem + ".";
+
+    DIR* handle = ::opendir(dir.c_str());
+    if (!handle) {
+        return;
+    }
+    std::vector<std::string> rotated;
+    const size_t suffix_size = std::strlen(kLogIndexSuffix);
+    while (dirent* entry = ::readdir(handle)) {
+        std::string name = entry->d_name;
+        bool index = name.size() > suffix_size &&
+                     name.compare(name.size() - suffix_size, suffix_size, kLogIndexSuffix) == 0;
+        // 形如 <名称>.<8 位日期>-... 且包含原扩展名
+        if (!index && name.size() > prefix.size() + 8 && name.compare(0, prefix.size(), prefix) == 0 &&
+            std::isdigit(static_cast<unsigned char>(name[prefix.size()])) &&
+            name.find(extension, prefix.size()) != std::string::npos) {
+            rotated.push_back(name);
+        }
+    }
+    ::closedir(handle);
+
+    if (rotated.size() <= max_files) {
+        return;
+    }
+    std::sort(rotated.begin(), rotated.end());
+    for (size_t i = 0; i + max_files < rotated.size(); ++i) {
+        ::unlink((dir + "/" + rotated[i]).c_str());
+        ::unlink(logIndexPath(dir + "/" + rotated[i]).c_str());
+    }
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_ROTATION_H
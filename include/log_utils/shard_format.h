@@ -0,0 +1,79 @@
+#ifndef LOG_UTILS_SHARD_FORMAT_H
+#define LOG_UTILS_SHARD_FORMAT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+// 汇总日志分片文件格式（ShardedSummarySink 写入，合并后写入汇总日志或由 log_merge 工具离线合并），不依赖 ROS
+//
+// 分片文件由若干记录组成，每条记录为定长记录头 + 渲染好的整行日志。
+// 记录头中的时间戳来自 steady_clock（纳秒），同一分片内单调不减；序号在分片内递增。
+// 合并时按 (时间戳, 分片编号, 序号) 做 k 路归并，结果即为按时间排序的汇总日志。
+// 记录头按写入机器的字节序保存，需要在相同架构上合并；进程崩溃时文件末尾可能有不完整的记录，合并时忽略
+
+namespace log_utils {
+
+struct ShardRecordHeader {
+    uint64_t timestamp_ns;
+    uint64_t sequence;
+    uint32_t size;      // 之后日志行的字节数
+    uint32_t reserved;
+};
+
+// 一个分片文件的内容
+struct ShardView {
+    const char* data;
+    size_t size;
+};
+
+// 按时间顺序归并所有分片，对每条记录调用 on_record(text, size)
+// 返回 false 表示有分片末尾存在不完整的记录（已忽略）
+inline bool mergeShards(const std::vector<ShardView>& shards,
+                        const std::function<void(const char*, size_t)>& on_record) {
+    // (时间戳, 分片编号, 序号, 记录偏移)
+    using Head = std::tuple<uint64_t, size_t, uint64_t, size_t>;
+    std::priority_queue<Head, std::vector<Head>, std::greater<Head>> heads;
+    bool complete = true;
+
+    auto push = [&](size_t shard, size_t offset) {
+        const ShardView& view = shards[shard];
+        if (offset == view.size) {
+            return;
+        }
+        ShardRecordHeader header;
+        if (view.size - offset < sizeof(header)) {
+            complete = false;
+            return;
+        }
+        std::memcpy(&header, view.data + offset, sizeof(header));
+        if (view.size - offset - sizeof(header) < header.size) {
+            complete = false;
+            return;
+        }
+        heads.emplace(header.timestamp_ns, shard, header.sequence, offset);
+    };
+
+    for (size_t shard = 0; shard < shards.size(); ++shard) {
+        push(shard, 0);
+    }
+    while (!heads.empty()) {
+        Head head = heads.top();
+        heads.pop();
+        size_t shard = std::get<1>(head);
+        size_t offset = std::get<3>(head);
+        ShardRecordHeader header;
+        std::memcpy(&header, shards[shard].data + offset, sizeof(header));
+        on_record(shards[shard].data + offset + sizeof(header), header.size);
+        push(shard, offset + sizeof(header) + header.size);
+    }
+    return complete;
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_SHARD_FORMAT_H
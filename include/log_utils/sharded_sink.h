@@ -0,0 +1,372 @@
+#ifndef LOG_UTILS_SHARDED_SINK_H
+#define LOG_UTILS_SHARDED_SINK_H
+
+#include <atomic>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/log_utils.h"
+#include "log_utils/shard_format.h"
+
+namespace log_utils {
+
+// 未合并的分片数据达到该大小时提前合并，限制每次合并读入内存的数据量
+constexpr size_t kShardMergeBytes = 4 * 1024 * 1024;
+
+// 分片汇总日志：每个 CPU 一个分片文件，线程只写入当前 CPU 的分片，不同 CPU 上的线程互不加锁
+// （分片自带的互斥锁只在线程迁移或合并时才会发生竞争）。
+// 分片记录带有单调时钟时间戳，后台线程每隔 merge_interval（或未合并的数据达到 kShardMergeBytes 时）
+// 按时间顺序归并所有分片并追加到汇总日志，然后清空分片；flush() 和析构时同样会合并一次。
+// 分片文件按 <汇总日志名>.shard-<pid>-<CPU 编号><扩展名> 命名，如 ALL_LOGS_SUMMARY.shard-4242-003.log，
+// 多个进程共用日志目录时各自只读写、删除自己的分片，分片在进程存活期间持有 flock。
+// 已退出进程（kill(pid, 0) 返回 ESRCH 且分片未被锁定）残留的分片在启动时先合并，也可以用 log_merge 工具离线合并
+class ShardedSummarySink : public LogSink {
+private:
+    struct alignas(64) Shard {
+        std::mutex mutex;
+        std::string path;
+        int fd = -1;
+        std::string buffer;  // 尚未写入分片文件的记录
+        uint64_t sequence = 0;
+        FlushOptions flush_options;
+        std::chrono::steady_clock::time_point last_flush;
+    };
+
+    std::shared_ptr<FileLogger> summary_;
+    LogLevel min_level_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::mutex merge_mutex_;
+    std::atomic<size_t> pending_bytes_{0};  // 上次合并以来写入分片的字节数
+
+    // 周期合并线程
+    std::chrono::milliseconds merge_interval_;
+    std::thread merge_thread_;
+    std::mutex merge_wait_mutex_;
+    std::condition_variable merge_cv_;
+    bool merge_running_ = false;
+
+    static size_t currentCpu() {
+        int cpu = ::sched_getcpu();
+        return cpu < 0 ? 0 : static_cast<size_t>(cpu);
+    }
+
+    bool openShardLocked(Shard& shard) {
+        shard.fd = ::open(shard.path.c_str(), O_RDWR | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+        if (shard.fd < 0) {
+            std::cerr << "Error: Cannot open log file: " << shard.path << std::endl;
+            return false;
+        }
+        // 持有锁期间其他进程不会把它当作残留分片合并（pid 命名空间不同时 kill 检查不可靠）
+        ::flock(shard.fd, LOCK_EX | LOCK_NB);
+        return true;
+    }
+
+    // 解析 <stem>.shard-<pid>-<CPU 编号><ext>，返回 pid，不匹配时返回 0
+    static long shardOwner(const std::string& name, const std::string& prefix, const std::string& extension) {
+        if (name.size() <= prefix.size() + extension.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+            name.compare(name.size() - extension.size(), extension.size(), extension) != 0) {
+            return 0;
+        }
+        std::string middle = name.substr(prefix.size(), name.size() - prefix.size() - extension.size());
+        size_t dash = middle.find('-');
+        if (dash == 0 || dash == std::string::npos || dash + 1 == middle.size() ||
+            middle.find_first_not_of("0123456789-") != std::string::npos ||
+            middle.find('-', dash + 1) != std::string::npos) {
+            return 0;
+        }
+        return std::strtol(middle.c_str(), nullptr, 10);
+    }
+
+    // 合并并删除已退出进程残留的分片（同一 pid 被本进程复用时，同名文件同样是残留）
+    void adoptLeftovers(const std::string& dir, const std::string& stem, const std::string& extension) {
+        DIR* handle = ::opendir(dir.c_str());
+        if (!handle) {
+            return;
+        }
+        std::string prefix = stem + ".shard-";
+        long self = static_cast<long>(::getpid());
+        std::vector<std::string> paths;
+        while (dirent* entry = ::readdir(handle)) {
+            long pid = shardOwner(entry->d_name, prefix, extension);
+            if (pid <= 0) {
+                continue;
+            }
+            if (pid != self && (::kill(static_cast<pid_t>(pid), 0) == 0 || errno != ESRCH)) {
+                continue;
+            }
+            paths.push_back(dir + "/" + entry->d_name);
+        }
+        ::closedir(handle);
+
+        std::vector<int> fds;
+        std::vector<std::string> adopted;
+        std::vector<std::string> contents;
+        for (const std::string& path : paths) {
+            int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                continue;
+            }
+            // 另一个进程可能同时在合并同一个残留分片：拿到锁后确认文件仍未被删除
+            struct stat by_fd, by_path;
+            if (::flock(fd, LOCK_EX | LOCK_NB) != 0 || ::fstat(fd, &by_fd) != 0 ||
+                ::stat(path.c_str(), &by_path) != 0 || by_fd.st_ino != by_path.st_ino ||
+                by_fd.st_dev != by_path.st_dev) {
+                ::close(fd);
+                continue;
+            }
+            contents.emplace_back();
+            readShard(fd, contents.back());
+            fds.push_back(fd);
+            adopted.push_back(path);
+        }
+        std::vector<ShardView> views;
+        for (const std::string& data : contents) {
+            if (!data.empty()) {
+                views.push_back(ShardView{data.data(), data.size()});
+            }
+        }
+        if (!views.empty()) {
+            if (!mergeShards(views, [this](const char* text, size_t size) {
+                    summary_->append(text, size, LogLevel::DEBUG);
+                })) {
+                std::cerr << "Warning: Incomplete record in summary shard ignored" << std::endl;
+            }
+            summary_->flush();
+        }
+        for (size_t i = 0; i < fds.size(); ++i) {
+            ::unlink(adopted[i].c_str());
+            ::close(fds[i]);
+        }
+    }
+
+    void mergeLoop() {
+        std::unique_lock<std::mutex> wait_lock(merge_wait_mutex_);
+        while (merge_running_) {
+            merge_cv_.wait_for(wait_lock, merge_interval_, [this] {
+                return !merge_running_ || pending_bytes_.load(std::memory_order_relaxed) >= kShardMergeBytes;
+            });
+            if (!merge_running_) {
+                break;
+            }
+            wait_lock.unlock();
+            merge();
+            wait_lock.lock();
+        }
+    }
+
+    // 把分片缓冲区写入分片文件（调用方持有 shard.mutex）
+    static void flushShardLocked(Shard& shard) {
+        size_t offset = 0;
+        while (offset < shard.buffer.size()) {
+            ssize_t n = ::write(shard.fd, shard.buffer.data() + offset, shard.buffer.size() - offset);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                break;
+            }
+            offset += static_cast<size_t>(n);
+        }
+        shard.buffer.clear();
+        shard.last_flush = std::chrono::steady_clock::now();
+    }
+
+    static bool shouldFlush(const Shard& shard, LogLevel level) {
+        if (shard.buffer.size() >= kMaxBufferedBytes) {
+            return true;
+        }
+        switch (shard.flush_options.policy) {
+            case FlushPolicy::EVERY_RECORD:  return true;
+            case FlushPolicy::ON_SEVERITY:   return level >= shard.flush_options.flush_level;
+            case FlushPolicy::EVERY_N_BYTES: return shard.buffer.size() >= shard.flush_options.flush_bytes;
+            case FlushPolicy::INTERVAL:      return false;
+        }
+        return true;
+    }
+
+    static bool readShard(int fd, std::string& data) {
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            return false;
+        }
+        data.resize(static_cast<size_t>(st.st_size));
+        size_t offset = 0;
+        while (offset < data.size()) {
+            ssize_t n = ::pread(fd, &data[offset], data.size() - offset, static_cast<off_t>(offset));
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            offset += static_cast<size_t>(n);
+        }
+        data.resize(offset);
+        return true;
+    }
+
+public:
+    // summary 为最终写入的汇总日志文件（通常是 LogManager::getSummaryLogger()）
+    // merge_interval 为后台合并的周期，汇总日志最多落后这么久
+    explicit ShardedSummarySink(std::shared_ptr<FileLogger> summary, LogLevel min_level = LogLevel::DEBUG,
+                                std::chrono::milliseconds merge_interval = std::chrono::milliseconds(1000))
+        : summary_(std::move(summary)), min_level_(min_level), merge_interval_(merge_interval) {
+        std::string dir, stem, extension;
+        splitLogPath(summary_->getFilePath(), dir, stem, extension);
+        adoptLeftovers(dir, stem, extension);
+        long cpus = ::sysconf(_SC_NPROCESSORS_CONF);
+        size_t count = cpus > 0 ? static_cast<size_t>(cpus) : 1;
+        long pid = static_cast<long>(::getpid());
+        for (size_t i = 0; i < count; ++i) {
+            std::unique_ptr<Shard> shard(new Shard());
+            char suffix[48];
+            std::snprintf(suffix, sizeof(suffix), ".shard-%ld-%03zu", pid, i);
+            shard->path = dir + "/" + stem + suffix + extension;
+            shard->last_flush = std::chrono::steady_clock::now();
+            shards_.push_back(std::move(shard));
+        }
+        merge_running_ = true;
+        merge_thread_ = std::thread(&ShardedSummarySink::mergeLoop, this);
+    }
+
+    ~ShardedSummarySink() override {
+        {
+            std::lock_guard<std::mutex> wait_lock(merge_wait_mutex_);
+            merge_running_ = false;
+        }
+        merge_cv_.notify_one();
+        if (merge_thread_.joinable()) {
+            merge_thread_.join();
+        }
+        merge();
+        // 只删除本进程的分片
+        for (auto& shard : shards_) {
+            if (shard->fd >= 0) {
+                ::unlink(shard->path.c_str());
+                ::close(shard->fd);
+            }
+        }
+    }
+
+    ShardedSummarySink(const ShardedSummarySink&) = delete;
+    ShardedSummarySink& operator=(const ShardedSummarySink&) = delete;
+
+    bool accepts(LogLevel level) const override {
+        return level >= min_level_ && summary_->isOpen();
+    }
+
+    void write(const LogEntry& entry) override {
+        Shard& shard = *shards_[currentCpu() % shards_.size()];
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        if (shard.fd < 0 && !openShardLocked(shard)) {
+            return;
+        }
+        // 时间戳在分片锁内读取，保证同一分片内单调不减
+        ShardRecordHeader header{static_cast<uint64_t>(steadyNanoseconds()), shard.sequence++,
+                                 static_cast<uint32_t>(entry.text_size), 0};
+        shard.buffer.append(reinterpret_cast<const char*>(&header), sizeof(header));
+        shard.buffer.append(entry.text, entry.text_size);
+        if (shouldFlush(shard, entry.level)) {
+            flushShardLocked(shard);
+        }
+        size_t bytes = sizeof(header) + entry.text_size;
+        size_t before = pending_bytes_.fetch_add(bytes, std::memory_order_relaxed);
+        if (before < kShardMergeBytes && before + bytes >= kShardMergeBytes) {
+            merge_cv_.notify_one();
+        }
+    }
+
+    // 按时间顺序把所有分片中的记录追加到汇总日志并清空分片；合并期间写入会短暂阻塞
+    void merge() {
+        std::lock_guard<std::mutex> merge_lock(merge_mutex_);
+        std::vector<std::unique_lock<std::mutex>> locks;
+        locks.reserve(shards_.size());
+        std::vector<std::string> contents(shards_.size());
+        std::vector<ShardView> views;
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            Shard& shard = *shards_[i];
+            locks.emplace_back(shard.mutex);
+            if (shard.fd < 0) {
+                continue;
+            }
+            flushShardLocked(shard);
+            if (readShard(shard.fd, contents[i]) && !contents[i].empty()) {
+                views.push_back(ShardView{contents[i].data(), contents[i].size()});
+            }
+        }
+        pending_bytes_.store(0, std::memory_order_relaxed);
+        if (views.empty()) {
+            return;
+        }
+
+        bool complete = mergeShards(views, [this](const char* text, size_t size) {
+            summary_->append(text, size, LogLevel::DEBUG);
+        });
+        if (!complete) {
+            std::cerr << "Warning: Incomplete record in summary shard ignored" << std::endl;
+        }
+        summary_->flush();
+        for (auto& shard : shards_) {
+            if (shard->fd >= 0 && ::ftruncate(shard->fd, 0) != 0) {
+                std::cerr << "Error: Cannot truncate log file: " << shard->path << std::endl;
+            }
+        }
+    }
+
+    void flush() override {
+        merge();
+    }
+
+    void flushIfDue(std::chrono::steady_clock::time_point now) override {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            if (shard->fd >= 0 && !shard->buffer.empty() &&
+                now - shard->last_flush >= shard->flush_options.flush_interval) {
+                flushShardLocked(*shard);
+            }
+        }
+    }
+
+    void setFlushOptions(const FlushOptions& options) override {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard->mutex);
+            shard->flush_options = options;
+            if (shard->fd >= 0) {
+                flushShardLocked(*shard);
+            }
+        }
+    }
+
+    size_t shardCount() const {
+        return shards_.size();
+    }
+};
+
+// 让汇总日志改为分片写入，返回新的输出目标（可用于手动 merge()）；共享内存传输下不适用，返回空指针
+inline std::shared_ptr<ShardedSummarySink> enableShardedSummary() {
+    auto& manager = LogManager::getInstance();
+    if (!manager.getSummaryLogger()) {
+        return nullptr;
+    }
+    auto sink = std::make_shared<ShardedSummarySink>(manager.getSummaryLogger());
+    manager.setSummarySink(sink);
+    return sink;
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_SHARDED_SINK_H
@@ -0,0 +1,307 @@
+#ifndef LOG_UTILS_SHM_RING_H
+#define LOG_UTILS_SHM_RING_H
+
+#include <atomic>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// 多进程共享内存日志传输（LOG_TRANSPORT=shm 时 LogManager 写入，log_collector 读取），不依赖 ROS
+//
+// 每个进程创建一个 POSIX 共享内存环形缓冲区 /dev/shm/log_utils.<目录键>.<pid>，
+// 目录键由日志目录的绝对路径计算，同一 LOG_DIR 下的进程和收集器使用相同的前缀。
+// 缓冲区为单生产者（进程内由互斥锁串行化）单消费者（收集器）的字节环：
+//   头部   魔数、版本、pid、容量、head（生产者写入的字节数）、tail（消费者读取的字节数）、丢弃计数、关闭标志
+//   数据区 若干 8 字节对齐的记录，记录跨越数据区末尾时先写一条填充记录
+// 记录包含单调时钟时间戳、进程内序号、级别、模块名和渲染好的整行日志，收集器按 (时间戳, pid, 序号) 排序
+
+namespace log_utils {
+
+constexpr char kShmRingMagic[8] = {'L', 'U', 'S', 'H', 'M', '0', '0', '1'};
+constexpr uint32_t kShmRingVersion = 1;
+constexpr size_t kDefaultShmRingSize = 4 * 1024 * 1024;
+
+struct ShmRingHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t pid;
+    uint64_t capacity;  // 数据区字节数，2 的幂
+    alignas(64) std::atomic<uint64_t> head;
+    alignas(64) std::atomic<uint64_t> tail;
+    alignas(64) std::atomic<uint64_t> dropped;  // 缓冲区已满而丢弃的记录数
+    std::atomic<uint32_t> closed;               // 生产者正常退出后置 1
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory ring needs lock-free atomics");
+
+enum class ShmRecordKind : uint32_t {
+    RECORD = 1,
+    PADDING = 2
+};
+
+struct ShmRecordHeader {
+    uint32_t size;  // 整条记录的字节数（含记录头，8 字节对齐）
+    uint32_t kind;
+    uint64_t timestamp_ns;  // CLOCK_MONOTONIC，同一台机器上的进程之间可比较
+    uint64_t sequence;
+    uint32_t text_size;
+    uint16_t module_size;
+    uint8_t level;
+    uint8_t reserved;
+};
+
+constexpr size_t kShmDataOffset = (sizeof(ShmRingHeader) + 63) & ~size_t(63);
+
+inline size_t alignRecord(size_t size) {
+    return (size + 7) & ~size_t(7);
+}
+
+// 日志目录对应的共享内存名前缀（不含开头的 '/'），如 log_utils.1f2e3d4c5b6a7988.
+inline std::string shmRingPrefix(const std::string& log_dir) {
+    char resolved[PATH_MAX];
+    std::string path = ::realpath(log_dir.c_str(), resolved) ? std::string(resolved) : log_dir;
+    uint64_t hash = 1469598103934665603ULL;  // FNV-1a
+    for (char ch : path) {
+        hash ^= static_cast<unsigned char>(ch);
+        hash *= 1099511628211ULL;
+    }
+    char prefix[48];
+    std::snprintf(prefix, sizeof(prefix), "log_utils.%016llx.", static_cast<unsigned long long>(hash));
+    return prefix;
+}
+
+// 生产者：创建本进程的环形缓冲区；push 需由调用方串行化
+class ShmRingWriter {
+private:
+    std::string name_;
+    ShmRingHeader* header_;
+    char* data_;
+    size_t mapped_size_;
+    uint64_t sequence_;
+
+public:
+    ShmRingWriter(const std::string& log_dir, size_t capacity = kDefaultShmRingSize)
+        : header_(nullptr), data_(nullptr), mapped_size_(0), sequence_(0) {
+        size_t rounded = 4096;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        name_ = "/" + shmRingPrefix(log_dir) + std::to_string(::getpid());
+        // 同名对象只可能是之前使用相同 pid 的进程留下的
+        ::shm_unlink(name_.c_str());
+        int fd = ::shm_open(name_.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (fd < 0) {
+            return;
+        }
+        mapped_size_ = kShmDataOffset + rounded;
+        if (::ftruncate(fd, static_cast<off_t>(mapped_size_)) != 0) {
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            return;
+        }
+        void* mapped = ::mmap(nullptr, mapped_size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            ::shm_unlink(name_.c_str());
+            return;
+        }
+        header_ = new (mapped) ShmRingHeader();
+        header_->version = kShmRingVersion;
+        header_->pid = static_cast<uint32_t>(::getpid());
+        header_->capacity = rounded;
+        header_->head.store(0, std::memory_order_relaxed);
+        header_->tail.store(0, std::memory_order_relaxed);
+        header_->dropped.store(0, std::memory_order_relaxed);
+        header_->closed.store(0, std::memory_order_relaxed);
+        data_ = static_cast<char*>(mapped) + kShmDataOffset;
+        // 魔数最后写入，收集器看到魔数时头部其他字段已经就绪
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header_->magic, kShmRingMagic, sizeof(kShmRingMagic));
+    }
+
+    // 标记关闭并解除映射，共享内存对象由收集器读完后删除
+    ~ShmRingWriter() {
+        if (header_) {
+            header_->closed.store(1, std::memory_order_release);
+            ::munmap(header_, mapped_size_);
+        }
+    }
+
+    ShmRingWriter(const ShmRingWriter&) = delete;
+    ShmRingWriter& operator=(const ShmRingWriter&) = delete;
+
+    bool isOpen() const {
+        return header_ != nullptr;
+    }
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    uint64_t dropped() const {
+        return header_ ? header_->dropped.load(std::memory_order_relaxed) : 0;
+    }
+
+    // 写入一条记录，缓冲区已满时丢弃并计数
+    bool push(uint64_t timestamp_ns, uint8_t level, const char* module, size_t module_size,
+              const char* text, size_t text_size) {
+        if (!header_) {
+            return false;
+        }
+        const uint64_t capacity = header_->capacity;
+        module_size = module_size > UINT16_MAX ? UINT16_MAX : module_size;
+        size_t size = alignRecord(sizeof(ShmRecordHeader) + module_size + text_size);
+        if (size > capacity / 2) {
+            header_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint64_t head = header_->head.load(std::memory_order_relaxed);
+        uint64_t tail = header_->tail.load(std::memory_order_acquire);
+        size_t offset = static_cast<size_t>(head & (capacity - 1));
+        size_t to_end = static_cast<size_t>(capacity) - offset;
+        size_t needed = to_end < size ? to_end + size : size;
+        if (capacity - (head - tail) < needed) {
+            header_->dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (to_end < size) {
+            ShmRecordHeader padding{};
+            padding.size = static_cast<uint32_t>(to_end);
+            padding.kind = static_cast<uint32_t>(ShmRecordKind::PADDING);
+            std::memcpy(data_ + offset, &padding, sizeof(uint32_t) * 2);
+            head += to_end;
+            offset = 0;
+        }
+
+        ShmRecordHeader record{};
+        record.size = static_cast<uint32_t>(size);
+        record.kind = static_cast<uint32_t>(ShmRecordKind::RECORD);
+        record.timestamp_ns = timestamp_ns;
+        record.sequence = sequence_++;
+        record.text_size = static_cast<uint32_t>(text_size);
+        record.module_size = static_cast<uint16_t>(module_size);
+        record.level = level;
+        char* out = data_ + offset;
+        std::memcpy(out, &record, sizeof(record));
+        std::memcpy(out + sizeof(record), module, module_size);
+        std::memcpy(out + sizeof(record) + module_size, text, text_size);
+        header_->head.store(head + size, std::memory_order_release);
+        return true;
+    }
+};
+
+// 消费者：收集器打开某个进程的环形缓冲区并读取其中的记录
+class ShmRingReader {
+private:
+    std::string name_;
+    ShmRingHeader* header_;
+    const char* data_;
+    size_t mapped_size_;
+
+public:
+    // name 为共享内存对象名（含开头的 '/'）
+    explicit ShmRingReader(const std::string& name)
+        : name_(name), header_(nullptr), data_(nullptr), mapped_size_(0) {
+        int fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) <= kShmDataOffset) {
+            ::close(fd);
+            return;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            return;
+        }
+        ShmRingHeader* header = static_cast<ShmRingHeader*>(mapped);
+        if (std::memcmp(header->magic, kShmRingMagic, sizeof(kShmRingMagic)) != 0 ||
+            header->version != kShmRingVersion || kShmDataOffset + header->capacity != size) {
+            ::munmap(mapped, size);
+            return;
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        header_ = header;
+        data_ = static_cast<const char*>(mapped) + kShmDataOffset;
+        mapped_size_ = size;
+    }
+
+    ~ShmRingReader() {
+        if (header_) {
+            ::munmap(header_, mapped_size_);
+        }
+    }
+
+    ShmRingReader(const ShmRingReader&) = delete;
+    ShmRingReader& operator=(const ShmRingReader&) = delete;
+
+    bool isOpen() const {
+        return header_ != nullptr;
+    }
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    uint32_t pid() const {
+        return header_->pid;
+    }
+
+    uint64_t dropped() const {
+        return header_->dropped.load(std::memory_order_relaxed);
+    }
+
+    // 生产者已正常关闭（之后不会再有新记录）
+    bool closed() const {
+        return header_->closed.load(std::memory_order_acquire) != 0;
+    }
+
+    // 读取当前所有记录，对每条调用 on_record(header, module, text)，返回读取的记录数
+    template<typename Callback>
+    size_t poll(Callback&& on_record) {
+        const uint64_t capacity = header_->capacity;
+        uint64_t tail = header_->tail.load(std::memory_order_relaxed);
+        uint64_t head = header_->head.load(std::memory_order_acquire);
+        size_t count = 0;
+        while (tail < head) {
+            const char* in = data_ + (tail & (capacity - 1));
+            ShmRecordHeader record;
+            std::memcpy(&record, in, sizeof(uint32_t) * 2);
+            if (record.size == 0 || record.size > capacity) {
+                // 数据损坏，丢弃剩余内容
+                tail = head;
+                break;
+            }
+            if (record.kind == static_cast<uint32_t>(ShmRecordKind::RECORD)) {
+                std::memcpy(&record, in, sizeof(record));
+                on_record(record, in + sizeof(record), in + sizeof(record) + record.module_size);
+                ++count;
+            }
+            tail += record.size;
+        }
+        header_->tail.store(tail, std::memory_order_release);
+        return count;
+    }
+
+    // 删除共享内存对象（读完已关闭或已退出进程的缓冲区后调用）
+    void unlink() {
+        ::shm_unlink(name_.c_str());
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_SHM_RING_H
@@ -0,0 +1,103 @@
+#ifndef LOG_UTILS_STRING_INDEX_H
+#define LOG_UTILS_STRING_INDEX_H
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace log_utils {
+
+// 只增不删的字符串索引，不依赖 ROS：查找无锁、无等待，插入由调用方串行化（如在其互斥锁内插入）
+// 开放寻址哈希表，槽位为指向条目的原子指针，插入时先写好条目再发布到槽位。
+// 条目数超过槽位数的一半时建一张两倍大的表，重新插入全部条目后整体发布；
+// 旧表保留到索引销毁（总大小不超过最新表），正在旧表上查找的线程不受影响
+// 键只保存 string_view，其指向的字符串由调用方保证在索引的生命周期内不变
+template<typename T>
+class StringIndex {
+private:
+    struct Entry {
+        std::string_view key;
+        size_t hash;
+        T value;
+    };
+
+    struct Table {
+        size_t mask;
+        std::unique_ptr<std::atomic<const Entry*>[]> slots;
+
+        explicit Table(size_t capacity) : mask(capacity - 1), slots(new std::atomic<const Entry*>[capacity]) {
+            for (size_t i = 0; i < capacity; ++i) {
+                slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+        }
+    };
+
+    std::atomic<const Table*> table_;
+    std::vector<std::unique_ptr<Table>> tables_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+
+    static void place(const Table& table, const Entry* entry) {
+        size_t index = entry->hash & table.mask;
+        while (table.slots[index].load(std::memory_order_relaxed)) {
+            index = (index + 1) & table.mask;
+        }
+        table.slots[index].store(entry, std::memory_order_release);
+    }
+
+public:
+    // 初始槽位数向上取整为 2 的幂
+    explicit StringIndex(size_t capacity = 64) : table_(nullptr) {
+        size_t slots = 2;
+        while (slots < capacity) {
+            slots <<= 1;
+        }
+        tables_.emplace_back(new Table(slots));
+        table_.store(tables_.back().get(), std::memory_order_release);
+    }
+
+    StringIndex(const StringIndex&) = delete;
+    StringIndex& operator=(const StringIndex&) = delete;
+
+    // 查找键对应的值，不存在时返回 T()；可与 insert 并发调用
+    T find(std::string_view key) const {
+        const Table* table = table_.load(std::memory_order_acquire);
+        size_t hash = std::hash<std::string_view>()(key);
+        for (size_t index = hash & table->mask;; index = (index + 1) & table->mask) {
+            const Entry* entry = table->slots[index].load(std::memory_order_acquire);
+            if (!entry) {
+                return T();
+            }
+            if (entry->hash == hash && entry->key == key) {
+                return entry->value;
+            }
+        }
+    }
+
+    // 插入新键（调用方保证键尚不存在，且不会与其他 insert 并发）
+    void insert(std::string_view key, T value) {
+        entries_.emplace_back(new Entry{key, std::hash<std::string_view>()(key), value});
+        const Table* table = tables_.back().get();
+        if (entries_.size() * 2 > table->mask + 1) {
+            tables_.emplace_back(new Table((table->mask + 1) * 2));
+            table = tables_.back().get();
+            for (const auto& entry : entries_) {
+                place(*table, entry.get());
+            }
+            table_.store(table, std::memory_order_release);
+        } else {
+            place(*table, entries_.back().get());
+        }
+    }
+
+    // 条目数（与 insert 相同，由调用方串行化）
+    size_t size() const {
+        return entries_.size();
+    }
+};
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_STRING_INDEX_H
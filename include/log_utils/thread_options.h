@@ -0,0 +1,63 @@
+#ifndef LOG_UTILS_THREAD_OPTIONS_H
+#define LOG_UTILS_THREAD_OPTIONS_H
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+
+// 日志系统后台线程（异步写线程、轮转压缩线程）的 CPU 绑定和调度设置，不依赖 ROS
+
+namespace log_utils {
+
+struct ThreadOptions {
+    std::vector<int> cpus;  // 允许运行的 CPU 编号，空表示不改变（继承创建它的线程）
+    int policy = -1;        // SCHED_OTHER / SCHED_BATCH / SCHED_IDLE / SCHED_FIFO / SCHED_RR，-1 表示不改变
+    int priority = 0;       // SCHED_FIFO / SCHED_RR 的静态优先级
+    int nice = 0;           // SCHED_OTHER / SCHED_BATCH 下的 nice 值，0 表示不改变
+};
+
+// 把设置应用到调用线程，name 为线程名（最长 15 个字符，便于在 top / ps 中识别）
+// 部分设置失败（如没有 CAP_SYS_NICE 时设置 SCHED_FIFO）时输出错误并继续应用其余设置
+inline bool applyThreadOptions(const ThreadOptions& options, const char* name) {
+    bool ok = true;
+    ::pthread_setname_np(::pthread_self(), name);
+    if (!options.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : options.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &set);
+            }
+        }
+        int error = ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set);
+        if (error != 0) {
+            std::cerr << "Error: Cannot set CPU affinity of " << name << ": " << std::strerror(error) << std::endl;
+            ok = false;
+        }
+    }
+    if (options.policy >= 0) {
+        sched_param param;
+        std::memset(&param, 0, sizeof(param));
+        param.sched_priority = options.priority;
+        int error = ::pthread_setschedparam(::pthread_self(), options.policy, &param);
+        if (error != 0) {
+            std::cerr << "Error: Cannot set scheduling policy of " << name << ": " << std::strerror(error) << std::endl;
+            ok = false;
+        }
+    }
+    // Linux 上 nice 值按线程生效，who 为 0 即调用线程
+    if (options.nice != 0 && ::setpriority(PRIO_PROCESS, 0, options.nice) != 0) {
+        std::cerr << "Error: Cannot set nice value of " << name << ": " << std::strerror(errno) << std::endl;
+        ok = false;
+    }
+    return ok;
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_THREAD_OPTIONS_H
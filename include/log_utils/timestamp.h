@@ -0,0 +1,115 @@
+#ifndef LOG_UTILS_TIMESTAMP_H
+#define LOG_UTILS_TIMESTAMP_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+
+namespace log_utils {
+
+// 时间戳小数部分的精度
+enum class TimestampPrecision {
+    MILLISECONDS = 0,  // 2023-12-07 14:30:25.123
+    MICROSECONDS = 1   // 2023-12-07 14:30:25.123456
+};
+
+// formatTimestamp 所需的最小缓冲区长度
+constexpr size_t kTimestampBufferSize = 32;
+
+// 将 [0, 10^width) 内的整数按固定宽度写成十进制数字（左侧补零）
+inline char* writeFixedDigits(char* out, uint32_t value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+
+// 时间戳格式化器：缓存当前秒的 "YYYY-MM-DD HH:MM:SS" 前缀，只在秒变化时调用 localtime_r，
+// 毫秒/微秒部分直接按整数写入。非线程安全，每个线程使用各自的实例
+class TimestampFormatter {
+private:
+    static constexpr size_t kPrefixSize = 19;
+
+    int64_t cached_second_;
+    char prefix_[kPrefixSize + 1];
+
+    void updatePrefix(int64_t second) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm tm_value;
+        localtime_r(&time, &tm_value);
+        char* out = prefix_;
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_year + 1900), 4);
+        *out++ = '-';
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_mon + 1), 2);
+        *out++ = '-';
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_mday), 2);
+        *out++ = ' ';
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_hour), 2);
+        *out++ = ':';
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_min), 2);
+        *out++ = ':';
+        out = writeFixedDigits(out, static_cast<uint32_t>(tm_value.tm_sec), 2);
+        *out = '\0';
+        cached_second_ = second;
+    }
+
+public:
+    TimestampFormatter() : cached_second_(INT64_MIN) {
+        prefix_[0] = '\0';
+    }
+
+    // 写入时间戳（不含方括号），返回写入长度；out 至少 kTimestampBufferSize 字节
+    size_t format(std::chrono::system_clock::time_point time_point, TimestampPrecision precision,
+                  char* out) {
+        int64_t us = std::chrono::duration_cast<std::chrono::microseconds>(
+            time_point.time_since_epoch()).count();
+        int64_t second = us / 1000000;
+        int64_t fraction = us % 1000000;
+        if (fraction < 0) {
+            fraction += 1000000;
+            --second;
+        }
+        if (second != cached_second_) {
+            updatePrefix(second);
+        }
+
+        std::memcpy(out, prefix_, kPrefixSize);
+        char* cursor = out + kPrefixSize;
+        *cursor++ = '.';
+        if (precision == TimestampPrecision::MICROSECONDS) {
+            cursor = writeFixedDigits(cursor, static_cast<uint32_t>(fraction), 6);
+        } else {
+            cursor = writeFixedDigits(cursor, static_cast<uint32_t>(fraction / 1000), 3);
+        }
+        *cursor = '\0';
+        return static_cast<size_t>(cursor - out);
+    }
+};
+
+// 全局时间戳精度
+inline std::atomic<TimestampPrecision>& timestampPrecisionSetting() {
+    static std::atomic<TimestampPrecision> precision(TimestampPrecision::MILLISECONDS);
+    return precision;
+}
+
+inline void setTimestampPrecision(TimestampPrecision precision) {
+    timestampPrecisionSetting().store(precision, std::memory_order_relaxed);
+}
+
+inline TimestampPrecision getTimestampPrecision() {
+    return timestampPrecisionSetting().load(std::memory_order_relaxed);
+}
+
+// 使用当前线程的格式化器按全局精度写入时间戳，返回写入长度
+inline size_t formatTimestamp(std::chrono::system_clock::time_point time_point, char* out) {
+    thread_local TimestampFormatter formatter;
+    return formatter.format(time_point, getTimestampPrecision(), out);
+}
+
+} // namespace log_utils
+
+#endif // LOG_UTILS_TIMESTAMP_H
@@ -0,0 +1,479 @@
+#ifndef LOG_UTILS_TRACE_H
+#define LOG_UTILS_TRACE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <pthread.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "log_utils/log_stats.h"
+#include "log_utils/rate_limit.h"
+#include "log_utils/realtime.h"
+
+// 作用域计时与跟踪事件，不依赖 ROS
+//
+// LOG_SCOPE_TIMER 在作用域结束时把耗时计入调用处的直方图：两次 steady_clock 读取（vDSO，不进入内核）
+// 和几次 relaxed 原子加，不格式化、不写日志。启用跟踪（LogManager::enableTracing）后，
+// 计时作用域和 LOG_TRACE_* 事件还会写入当前线程的环形缓冲区（写满后覆盖最早的事件），
+// 可导出为 Chrome trace 格式的 JSON，用 chrome://tracing 或 ui.perfetto.dev 打开
+
+namespace log_utils {
+
+enum class TracePhase : char {
+    COMPLETE = 'X',  // 计时作用域（开始时间和耗时）
+    INSTANT = 'i',
+    BEGIN = 'B',     // 同一线程内成对出现，可跨越作用域
+    END = 'E',
+    COUNTER = 'C'
+};
+
+// 跟踪配置
+struct TraceOptions {
+    size_t events_per_thread = 64 * 1024;  // 每个线程保留的最近事件数（向上取整为 2 的幂）
+    bool export_at_exit = true;            // 程序结束时导出到 LOG_DIR/TRACE_<pid>.json
+    size_t retired_buffers = 8;            // 保留的已退出线程缓冲区数，超出时丢弃最早退出的线程的事件
+};
+
+// 一个计时器的统计快照
+struct TimerStats {
+    std::string module;
+    std::string name;
+    uint64_t count;
+    uint64_t total_ns;
+    uint64_t p50_ns;  // 分位数为所在 2 的幂桶的上界
+    uint64_t p99_ns;
+    uint64_t max_ns;
+};
+
+// 计时或跟踪的调用处：模块、名称（字符串字面量）和耗时直方图
+// 成员都是平凡析构的原子变量，程序退出时导出期间仍可安全访问
+struct alignas(kCacheLineSize) TraceSite {
+    const char* module;
+    const char* name;
+    std::atomic<uint64_t> total_ns{0};
+    LatencyHistogram histogram;
+
+    TraceSite(const char* module, const char* name);
+
+    void record(uint64_t ns) {
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        histogram.record(ns);
+    }
+};
+
+// 单个线程的事件环形缓冲区，只有所属线程写入
+// 写入时先递增 claimed_ 再写槽位，写完递增 committed_；导出线程读完槽位后再读 claimed_，
+// 丢弃期间已被覆盖的事件（与 seqlock 相同），不需要加锁
+class TraceBuffer {
+private:
+    struct Slot {
+        std::atomic<const TraceSite*> site{nullptr};
+        std::atomic<int64_t> time_ns{0};
+        std::atomic<int64_t> value{0};  // COMPLETE 为耗时（纳秒），COUNTER 为计数值
+        std::atomic<char> phase{0};
+    };
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t mask_;
+    std::atomic<uint64_t> claimed_{0};
+    std::atomic<uint64_t> committed_{0};
+    uint32_t tid_;
+    std::string thread_name_;
+
+public:
+    struct Event {
+        const TraceSite* site;
+        int64_t time_ns;
+        int64_t value;
+        TracePhase phase;
+    };
+
+    explicit TraceBuffer(size_t capacity) {
+        size_t size = 2;
+        while (size < capacity) {
+            size <<= 1;
+        }
+        slots_.reset(new Slot[size]);
+        mask_ = size - 1;
+        attach();
+    }
+
+    // 清空事件并归属到当前线程；复用已退出线程的缓冲区时由 TraceRecorder 在锁内调用
+    void attach() {
+        claimed_.store(0, std::memory_order_relaxed);
+        committed_.store(0, std::memory_order_relaxed);
+        tid_ = static_cast<uint32_t>(::syscall(SYS_gettid));
+        char name[16] = {};
+        thread_name_ = ::pthread_getname_np(::pthread_self(), name, sizeof(name)) == 0 ? name : "";
+    }
+
+    void push(const TraceSite* site, TracePhase phase, int64_t time_ns, int64_t value) {
+        uint64_t index = claimed_.load(std::memory_order_relaxed);
+        claimed_.store(index + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        Slot& slot = slots_[index & mask_];
+        slot.site.store(site, std::memory_order_relaxed);
+        slot.time_ns.store(time_ns, std::memory_order_relaxed);
+        slot.value.store(value, std::memory_order_relaxed);
+        slot.phase.store(static_cast<char>(phase), std::memory_order_relaxed);
+        committed_.store(index + 1, std::memory_order_release);
+    }
+
+    // 复制当前保留的事件（按写入顺序）
+    std::vector<Event> snapshot() const {
+        uint64_t end = committed_.load(std::memory_order_acquire);
+        uint64_t begin = end > mask_ + 1 ? end - (mask_ + 1) : 0;
+        std::vector<Event> events;
+        events.reserve(static_cast<size_t>(end - begin));
+        for (uint64_t i = begin; i < end; ++i) {
+            const Slot& slot = slots_[i & mask_];
+            events.push_back(Event{slot.site.load(std::memory_order_relaxed),
+                                   slot.time_ns.load(std::memory_order_relaxed),
+                                   slot.value.load(std::memory_order_relaxed),
+                                   static_cast<TracePhase>(slot.phase.load(std::memory_order_relaxed))});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t claimed = claimed_.load(std::memory_order_relaxed);
+        // 序号小于 claimed - 容量 的槽位在复制期间可能已被改写
+        uint64_t valid = claimed > mask_ + 1 ? claimed - (mask_ + 1) : 0;
+        if (valid > begin) {
+            events.erase(events.begin(), events.begin() + static_cast<ptrdiff_t>(std::min(valid, end) - begin));
+        }
+        return events;
+    }
+
+    uint32_t tid() const {
+        return tid_;
+    }
+
+    const std::string& threadName() const {
+        return thread_name_;
+    }
+};
+
+// 所有计时器和线程缓冲区的注册表
+// 线程退出时缓冲区转入 retired_，其中的事件仍会被导出；导出过的缓冲区由之后新建的线程复用，
+// 未导出的最多保留 retired_buffers 个，频繁创建线程的程序占用的内存不会随线程数增长
+class TraceRecorder {
+private:
+    // 已退出线程的缓冲区，按退出顺序排列
+    struct RetiredBuffer {
+        std::unique_ptr<TraceBuffer> buffer;
+        bool exported;
+    };
+
+    // 线程退出时归还缓冲区
+    struct ThreadBuffer {
+        TraceBuffer* buffer = nullptr;
+
+        ~ThreadBuffer() {
+            if (buffer) {
+                TraceRecorder::getInstance().retireBuffer(buffer);
+            }
+        }
+    };
+
+    mutable std::mutex mutex_;
+    std::vector<TraceSite*> sites_;
+    std::vector<std::unique_ptr<TraceBuffer>> buffers_;  // 运行中线程的缓冲区
+    std::vector<RetiredBuffer> retired_;
+    std::atomic<bool> enabled_;
+    TraceOptions options_;
+    int64_t start_ns_;
+
+    TraceRecorder() : enabled_(false), start_ns_(steadyNanoseconds()) {}
+
+    TraceBuffer* createBuffer() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto reusable = std::find_if(retired_.begin(), retired_.end(),
+                                     [](const RetiredBuffer& retired) { return retired.exported; });
+        if (reusable != retired_.end()) {
+            buffers_.push_back(std::move(reusable->buffer));
+            retired_.erase(reusable);
+            buffers_.back()->attach();
+        } else {
+            buffers_.emplace_back(new TraceBuffer(options_.events_per_thread));
+        }
+        return buffers_.back().get();
+    }
+
+    void retireBuffer(TraceBuffer* buffer) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = std::find_if(buffers_.begin(), buffers_.end(),
+                               [buffer](const std::unique_ptr<TraceBuffer>& owned) { return owned.get() == buffer; });
+        if (it == buffers_.end()) {
+            return;
+        }
+        retired_.push_back(RetiredBuffer{std::move(*it), false});
+        buffers_.erase(it);
+        // 超出上限时优先释放已导出的缓冲区，其次是最早退出的线程的缓冲区
+        while (retired_.size() > options_.retired_buffers) {
+            auto victim = std::find_if(retired_.begin(), retired_.end(),
+                                       [](const RetiredBuffer& retired) { return retired.exported; });
+            retired_.erase(victim != retired_.end() ? victim : retired_.begin());
+        }
+    }
+
+    static void writeEscaped(std::FILE* out, const char* text) {
+        for (; *text; ++text) {
+            unsigned char ch = static_cast<unsigned char>(*text);
+            if (ch == '"' || ch == '\\') {
+                std::fputc('\\', out);
+                std::fputc(ch, out);
+            } else if (ch < 0x20) {
+                std::fprintf(out, "\\u%04x", ch);
+            } else {
+                std::fputc(ch, out);
+            }
+        }
+    }
+
+public:
+    static TraceRecorder& getInstance() {
+        static TraceRecorder instance;
+        return instance;
+    }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    void addSite(TraceSite* site) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        sites_.push_back(site);
+    }
+
+    // 开始记录跟踪事件；已创建的线程缓冲区保持原有容量
+    void enable(const TraceOptions& options) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            options_ = options;
+        }
+        enabled_.store(true, std::memory_order_release);
+    }
+
+    void disable() {
+        enabled_.store(false, std::memory_order_release);
+    }
+
+    bool enabled() const {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    TraceOptions options() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return options_;
+    }
+
+    // 当前线程的缓冲区，首次调用时创建或复用已导出的缓冲区（实时线程应在进入实时循环前由
+    // setRealtimeThread 创建），线程退出时归还
+    TraceBuffer* threadBuffer() {
+        thread_local ThreadBuffer thread_buffer;
+        if (!thread_buffer.buffer) {
+            if (isRealtimeThread()) {
+                noteRealtimeViolation();
+            }
+            thread_buffer.buffer = createBuffer();
+        }
+        return thread_buffer.buffer;
+    }
+
+    void record(const TraceSite* site, TracePhase phase, int64_t time_ns, int64_t value) {
+        if (enabled()) {
+            threadBuffer()->push(site, phase, time_ns, value);
+        }
+    }
+
+    // 所有计时器的统计（没有样本的计时器除外）
+    std::vector<TimerStats> timerStats() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<TimerStats> stats;
+        for (const TraceSite* site : sites_) {
+            uint64_t count = site->histogram.count();
+            if (count == 0) {
+                continue;
+            }
+            stats.push_back(TimerStats{site->module, site->name, count,
+                                       site->total_ns.load(std::memory_order_relaxed),
+                                       site->histogram.percentile(0.5), site->histogram.percentile(0.99),
+                                       site->histogram.max()});
+        }
+        return stats;
+    }
+
+    void resetTimerStats() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (TraceSite* site : sites_) {
+            site->total_ns.store(0, std::memory_order_relaxed);
+            site->histogram.reset();
+        }
+    }
+
+    // 以 Chrome trace 格式导出所有线程（包括已退出的线程）缓冲区中的事件，时间相对于跟踪器创建的时刻
+    // 导出期间持有锁，已退出线程的缓冲区在导出完成后才能被复用
+    bool exportChromeTrace(const std::string& path) {
+        std::FILE* out = std::fopen(path.c_str(), "w");
+        if (!out) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<const TraceBuffer*> buffers;
+        for (const auto& buffer : buffers_) {
+            buffers.push_back(buffer.get());
+        }
+        for (const RetiredBuffer& retired : retired_) {
+            buffers.push_back(retired.buffer.get());
+        }
+        int pid = static_cast<int>(::getpid());
+        std::fprintf(out, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+        bool first = true;
+        for (const TraceBuffer* buffer : buffers) {
+            std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%u,\"args\":{\"name\":\"",
+                         first ? "" : ",\n", pid, buffer->tid());
+            writeEscaped(out, buffer->threadName().empty() ? "thread" : buffer->threadName().c_str());
+            std::fprintf(out, "\"}}");
+            first = false;
+            for (const TraceBuffer::Event& event : buffer->snapshot()) {
+                if (!event.site) {
+                    continue;
+                }
+                double ts_us = static_cast<double>(event.time_ns - start_ns_) / 1000.0;
+                std::fprintf(out, ",\n{\"name\":\"");
+                writeEscaped(out, event.site->name);
+                std::fprintf(out, "\",\"cat\":\"");
+                writeEscaped(out, event.site->module);
+                std::fprintf(out, "\",\"ph\":\"%c\",\"pid\":%d,\"tid\":%u,\"ts\":%.3f",
+                             static_cast<char>(event.phase), pid, buffer->tid(), ts_us);
+                switch (event.phase) {
+                    case TracePhase::COMPLETE:
+                        std::fprintf(out, ",\"dur\":%.3f", static_cast<double>(event.value) / 1000.0);
+                        break;
+                    case TracePhase::COUNTER:
+                        std::fprintf(out, ",\"args\":{\"value\":%lld}", static_cast<long long>(event.value));
+                        break;
+                    case TracePhase::INSTANT:
+                        std::fprintf(out, ",\"s\":\"t\"");
+                        break;
+                    default:
+                        break;
+                }
+                std::fprintf(out, "}");
+            }
+        }
+        std::fprintf(out, "\n]}\n");
+        bool ok = std::fclose(out) == 0;
+        if (ok) {
+            for (RetiredBuffer& retired : retired_) {
+                retired.exported = true;
+            }
+        }
+        return ok;
+    }
+};
+
+inline TraceSite::TraceSite(const char* module, const char* name) : module(module), name(name) {
+    // 首次执行时注册需要加锁，实时线程中的计时器应先在初始化阶段执行一次
+    if (isRealtimeThread()) {
+        noteRealtimeViolation();
+    }
+    TraceRecorder::getInstance().addSite(this);
+}
+
+// LOG_SCOPE_TIMER 的计时对象：析构时记录耗时
+class ScopedTimer {
+private:
+    TraceSite& site_;
+    int64_t begin_ns_;
+
+public:
+    explicit ScopedTimer(TraceSite& site) : site_(site), begin_ns_(steadyNanoseconds()) {}
+
+    ~ScopedTimer() {
+        int64_t end_ns = steadyNanoseconds();
+        uint64_t elapsed = static_cast<uint64_t>(end_ns - begin_ns_);
+        site_.record(elapsed);
+        TraceRecorder::getInstance().record(&site_, TracePhase::COMPLETE, begin_ns_, static_cast<int64_t>(elapsed));
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    // 到目前为止的耗时
+    uint64_t elapsedNs() const {
+        return static_cast<uint64_t>(steadyNanoseconds() - begin_ns_);
+    }
+};
+
+// 记录一个跟踪事件（未启用跟踪时不做任何事）
+inline void traceEvent(const TraceSite& site, TracePhase phase, int64_t value = 0) {
+    TraceRecorder& recorder = TraceRecorder::getInstance();
+    if (recorder.enabled()) {
+        recorder.record(&site, phase, steadyNanoseconds(), value);
+    }
+}
+
+inline std::vector<TimerStats> timerStats() {
+    return TraceRecorder::getInstance().timerStats();
+}
+
+inline void resetTimerStats() {
+    TraceRecorder::getInstance().resetTimerStats();
+}
+
+} // namespace log_utils
+
+#define LOG_UTILS_CONCAT_IMPL(a, b) a##b
+#define LOG_UTILS_CONCAT(a, b) LOG_UTILS_CONCAT_IMPL(a, b)
+
+// 定义 LOG_UTILS_DISABLE_TRACE 时所有计时和跟踪宏都不产生代码
+#ifndef LOG_UTILS_DISABLE_TRACE
+
+// 从此处到所在作用域结束的耗时计入计时器 name（字符串字面量），启用跟踪时同时记录一个跟踪事件
+//   { LOG_SCOPE_TIMER(Planner, "replan"); replan(); }
+#define LOG_SCOPE_TIMER(module, name) \
+    static log_utils::TraceSite LOG_UTILS_CONCAT(__log_utils_trace_site_, __LINE__)(#module, name); \
+    log_utils::ScopedTimer LOG_UTILS_CONCAT(__log_utils_scope_timer_, __LINE__)( \
+        LOG_UTILS_CONCAT(__log_utils_trace_site_, __LINE__))
+
+#define LOG_UTILS_TRACE_EVENT(module, name, phase, value) \
+    do { \
+        if (log_utils::TraceRecorder::getInstance().enabled()) { \
+            static log_utils::TraceSite __log_utils_trace_site(#module, name); \
+            log_utils::traceEvent(__log_utils_trace_site, phase, value); \
+        } \
+    } while(0)
+
+// 瞬时事件
+#define LOG_TRACE_INSTANT(module, name) \
+    LOG_UTILS_TRACE_EVENT(module, name, log_utils::TracePhase::INSTANT, 0)
+
+// 同一线程内成对使用的开始 / 结束事件，可跨越作用域（如回调开始和结束）
+#define LOG_TRACE_BEGIN(module, name) \
+    LOG_UTILS_TRACE_EVENT(module, name, log_utils::TracePhase::BEGIN, 0)
+
+#define LOG_TRACE_END(module, name) \
+    LOG_UTILS_TRACE_EVENT(module, name, log_utils::TracePhase::END, 0)
+
+// 计数器：在跟踪视图中显示为随时间变化的曲线（如队列长度）
+#define LOG_TRACE_COUNTER(module, name, value) \
+    LOG_UTILS_TRACE_EVENT(module, name, log_utils::TracePhase::COUNTER, static_cast<int64_t>(value))
+
+#else
+
+#define LOG_SCOPE_TIMER(module, name) static_assert(true, "")
+#define LOG_TRACE_INSTANT(module, name) do {} while(0)
+#define LOG_TRACE_BEGIN(module, name) do {} while(0)
+#define LOG_TRACE_END(module, name) do {} while(0)
+#define LOG_TRACE_COUNTER(module, name, value) do {} while(0)
+
+#endif
+
+#endif // LOG_UTILS_TRACE_H
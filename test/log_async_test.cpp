@@ -0,0 +1,112 @@
+// 异步模式开关的回归测试：多个线程持续写日志时反复启用和关闭异步模式，每条记录都应恰好写出一次
+// （包括超过队列槽位容量、保存在堆上的长消息），不会停留在队列中或被丢弃
+// 日志写入本次运行新建的私有目录 /tmp/log_utils_test.XXXXXX，结束时删除
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include <gtest/gtest.h>
+
+#include "log_utils/log_utils.h"
+
+namespace {
+
+char test_dir[] = "/tmp/log_utils_test.XXXXXX";
+
+int removeEntry(const char* path, const struct stat* st, int type, struct FTW* ftw) {
+    (void)st;
+    (void)type;
+    (void)ftw;
+    return ::remove(path);
+}
+
+void removeTestDir() {
+    ::nftw(test_dir, removeEntry, 16, FTW_DEPTH | FTW_PHYS);
+}
+
+// 统计写出的记录数及其中长消息的条数
+class CountingSink : public log_utils::LogSink {
+public:
+    std::atomic<uint64_t> records{0};
+    std::atomic<uint64_t> long_records{0};
+
+    void write(const log_utils::LogEntry& entry) override {
+        records.fetch_add(1, std::memory_order_relaxed);
+        if (entry.message_size > log_utils::kLogRecordMessageSize) {
+            long_records.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+TEST(LogAsync, ToggleUnderLoadWritesEveryRecord) {
+    auto& manager = log_utils::LogManager::getInstance();
+    log_utils::AsyncOptions options;
+    options.overflow_policy = log_utils::OverflowPolicy::BLOCK;
+    auto sink = std::make_shared<CountingSink>();
+    manager.addSink("AsyncToggle", sink);
+
+    const std::string long_text(2 * log_utils::kLogRecordMessageSize, 'x');
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> submitted_long{0};
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 3; ++t) {
+        producers.emplace_back([&, t] {
+            uint64_t count = 0;
+            uint64_t long_count = 0;
+            while (!stop.load(std::memory_order_relaxed)) {
+                if (count % 64 == 0) {
+                    LOG(AsyncToggle, INFO, "producer %d record %llu %s", t,
+                        static_cast<unsigned long long>(count), long_text.c_str());
+                    ++long_count;
+                } else {
+                    LOG(AsyncToggle, INFO, "producer %d record %llu", t, static_cast<unsigned long long>(count));
+                }
+                ++count;
+            }
+            submitted.fetch_add(count);
+            submitted_long.fetch_add(long_count);
+        });
+    }
+
+    for (int i = 0; i < 300; ++i) {
+        manager.enableAsync(options);
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+        manager.disableAsync();
+        // 关闭后队列中不应留下任何记录：此后没有写线程处理它们，要到下次启用时才会写出
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        ASSERT_EQ(manager.getStats().queue_depth, 0u) << "after toggle " << i;
+    }
+    stop = true;
+    for (std::thread& producer : producers) {
+        producer.join();
+    }
+
+    EXPECT_GT(submitted.load(), 0u);
+    EXPECT_EQ(manager.getDroppedCount(), 0u);
+    EXPECT_EQ(sink->records.load(), submitted.load());
+    EXPECT_EQ(sink->long_records.load(), submitted_long.load());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (!::mkdtemp(test_dir)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    ::setenv("LOG_DIR", test_dir, 1);
+    // 在 LogManager 构造之前注册，程序退出时在其析构（导出、关闭文件）之后执行
+    std::atexit(removeTestDir);
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,248 @@
+// 多进程日志收集器：读取同一日志目录下所有进程（LOG_TRANSPORT=shm）的共享内存环形缓冲区，
+// 按单调时钟时间戳排序后写入 ALL_LOGS_SUMMARY.log 和各模块日志，得到整个系统统一的时间线
+// 用法: log_collector [日志目录]，未指定时与 LogManager 相同（LOG_DIR、ROS_WORKSPACE/logs/current 或默认路径）
+// 收到 SIGINT / SIGTERM 后读完所有缓冲区再退出
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <memory>
+#include <queue>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/rotation.h"
+#include "log_utils/shm_ring.h"
+
+namespace {
+
+// 记录在收集器中停留的时间：各进程写入时间戳与写入缓冲区之间的延迟在此窗口内都能正确排序
+constexpr std::chrono::milliseconds kReorderWindow(100);
+constexpr std::chrono::milliseconds kScanInterval(50);  // 小于排序窗口，新进程的记录不会晚于窗口才被发现
+constexpr std::chrono::milliseconds kIdleSleep(5);
+
+std::atomic<bool> g_stop(false);
+
+void onSignal(int) {
+    g_stop.store(true);
+}
+
+struct Pending {
+    uint64_t timestamp_ns;
+    uint32_t pid;
+    uint64_t sequence;
+    std::string module;
+    std::string text;
+
+    bool operator>(const Pending& other) const {
+        return std::tie(timestamp_ns, pid, sequence) >
+               std::tie(other.timestamp_ns, other.pid, other.sequence);
+    }
+};
+
+struct Process {
+    std::unique_ptr<log_utils::ShmRingReader> reader;
+    uint64_t reported_dropped = 0;
+};
+
+uint64_t monotonicNanoseconds() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+std::string defaultLogDirectory() {
+    if (const char* log_dir = std::getenv("LOG_DIR")) {
+        return log_dir;
+    }
+    if (const char* workspace = std::getenv("ROS_WORKSPACE")) {
+        return std::string(workspace) + "/logs/current";
+    }
+    return "/tmp/two_stage_int_logs";
+}
+
+class Collector {
+private:
+    std::string log_dir_;
+    std::string prefix_;
+    std::map<std::string, Process> processes_;  // 按共享内存名索引
+    std::priority_queue<Pending, std::vector<Pending>, std::greater<Pending>> pending_;
+    FILE* summary_;
+    std::map<std::string, FILE*> module_files_;
+
+    FILE* moduleFile(const std::string& module) {
+        auto it = module_files_.find(module);
+        if (it != module_files_.end()) {
+            return it->second;
+        }
+        std::string path = log_dir_ + "/" + module + ".log";
+        FILE* file = std::fopen(path.c_str(), "a");
+        if (!file) {
+            std::fprintf(stderr, "Error: Cannot open log file: %s\n", path.c_str());
+        }
+        module_files_.emplace(module, file);
+        return file;
+    }
+
+public:
+    explicit Collector(const std::string& log_dir)
+        : log_dir_(log_dir), prefix_(log_utils::shmRingPrefix(log_dir)), summary_(nullptr) {
+        std::string path = log_dir_ + "/ALL_LOGS_SUMMARY.log";
+        summary_ = std::fopen(path.c_str(), "a");
+        if (!summary_) {
+            std::fprintf(stderr, "Error: Cannot open log file: %s\n", path.c_str());
+        }
+    }
+
+    ~Collector() {
+        if (summary_) {
+            std::fclose(summary_);
+        }
+        for (auto& pair : module_files_) {
+            if (pair.second) {
+                std::fclose(pair.second);
+            }
+        }
+    }
+
+    bool isOpen() const {
+        return summary_ != nullptr;
+    }
+
+    // 查找新启动进程的缓冲区
+    void scan() {
+        DIR* handle = ::opendir("/dev/shm");
+        if (!handle) {
+            return;
+        }
+        while (dirent* entry = ::readdir(handle)) {
+            std::string name = entry->d_name;
+            if (name.compare(0, prefix_.size(), prefix_) != 0) {
+                continue;
+            }
+            std::string shm_name = "/" + name;
+            if (processes_.count(shm_name)) {
+                continue;
+            }
+            std::unique_ptr<log_utils::ShmRingReader> reader(new log_utils::ShmRingReader(shm_name));
+            if (reader->isOpen()) {
+                processes_[shm_name].reader = std::move(reader);
+            }
+        }
+        ::closedir(handle);
+    }
+
+    // 读取所有缓冲区；已退出进程的缓冲区读完后删除。返回读取的记录数
+    size_t poll() {
+        size_t count = 0;
+        for (auto it = processes_.begin(); it != processes_.end();) {
+            log_utils::ShmRingReader& reader = *it->second.reader;
+            // 先判断是否已关闭再读取，保证关闭前写入的记录都已读到
+            bool exited = reader.closed() || (::kill(static_cast<pid_t>(reader.pid()), 0) != 0 && errno == ESRCH);
+            uint32_t pid = reader.pid();
+            count += reader.poll([&](const log_utils::ShmRecordHeader& record, const char* module,
+                                     const char* text) {
+                pending_.push(Pending{record.timestamp_ns, pid, record.sequence,
+                                      std::string(module, record.module_size),
+                                      std::string(text, record.text_size)});
+            });
+
+            uint64_t dropped = reader.dropped();
+            if (dropped > it->second.reported_dropped) {
+                std::fprintf(stderr, "Warning: pid %u dropped %llu records (shared memory buffer full)\n", pid,
+                             static_cast<unsigned long long>(dropped - it->second.reported_dropped));
+                it->second.reported_dropped = dropped;
+            }
+
+            if (exited) {
+                reader.unlink();
+                it = processes_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+        return count;
+    }
+
+    // 写出时间戳早于 deadline 的记录
+    void emit(uint64_t deadline_ns) {
+        bool wrote = false;
+        while (!pending_.empty() && pending_.top().timestamp_ns <= deadline_ns) {
+            const Pending& record = pending_.top();
+            if (summary_) {
+                std::fwrite(record.text.data(), 1, record.text.size(), summary_);
+            }
+            if (FILE* file = moduleFile(record.module)) {
+                std::fwrite(record.text.data(), 1, record.text.size(), file);
+            }
+            pending_.pop();
+            wrote = true;
+        }
+        if (wrote) {
+            if (summary_) {
+                std::fflush(summary_);
+            }
+            for (auto& pair : module_files_) {
+                if (pair.second) {
+                    std::fflush(pair.second);
+                }
+            }
+        }
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc > 2) {
+        std::fprintf(stderr, "Usage: %s [log directory]\n", argv[0]);
+        return 2;
+    }
+    std::string log_dir = argc == 2 ? argv[1] : defaultLogDirectory();
+    log_utils::createDirectories(log_dir);
+
+    Collector collector(log_dir);
+    if (!collector.isOpen()) {
+        return 1;
+    }
+
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = onSignal;
+    sigemptyset(&action.sa_mask);
+    ::sigaction(SIGINT, &action, nullptr);
+    ::sigaction(SIGTERM, &action, nullptr);
+
+    auto last_scan = std::chrono::steady_clock::time_point();
+    while (!g_stop.load()) {
+        auto now = std::chrono::steady_clock::now();
+        if (now - last_scan >= kScanInterval) {
+            collector.scan();
+            last_scan = now;
+        }
+        size_t count = collector.poll();
+        uint64_t window = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(kReorderWindow).count());
+        uint64_t now_ns = monotonicNanoseconds();
+        collector.emit(now_ns > window ? now_ns - window : 0);
+        if (count == 0) {
+            std::this_thread::sleep_for(kIdleSleep);
+        }
+    }
+
+    // 退出前读完所有缓冲区
+    collector.scan();
+    collector.poll();
+    collector.emit(UINT64_MAX);
+    return 0;
+}
@@ -0,0 +1,78 @@
+// 二进制日志解码工具：把 BinaryLogSink 写出的文件还原为与文本日志完全相同的格式
+// 用法: log_decode <二进制日志> [输出文件]，未指定输出文件时写到标准输出
+// 时间戳按本机时区还原，可通过 TZ 环境变量指定与记录时相同的时区
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/binary_format.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2 || argc > 3) {
+        std::fprintf(stderr, "Usage: %s <binary log> [output file]\n", argv[0]);
+        return 2;
+    }
+
+    int fd = ::open(argv[1], O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::fprintf(stderr, "Error: Cannot open %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Error: Cannot stat %s: %s\n", argv[1], std::strerror(errno));
+        ::close(fd);
+        return 1;
+    }
+    size_t size = static_cast<size_t>(st.st_size);
+    const char* data = nullptr;
+    if (size > 0) {
+        void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            std::fprintf(stderr, "Error: Cannot map %s: %s\n", argv[1], std::strerror(errno));
+            ::close(fd);
+            return 1;
+        }
+        data = static_cast<const char*>(mapped);
+    }
+    ::close(fd);
+
+    FILE* out = stdout;
+    if (argc == 3) {
+        out = std::fopen(argv[2], "w");
+        if (!out) {
+            std::fprintf(stderr, "Error: Cannot open %s: %s\n", argv[2], std::strerror(errno));
+            return 1;
+        }
+    }
+    static char out_buffer[1 << 20];
+    std::setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    log_utils::BinaryLogDecoder decoder;
+    size_t lines = 0;
+    bool ok = decoder.decode(data, size, [&](const std::string& line) {
+        std::fwrite(line.data(), 1, line.size(), out);
+        ++lines;
+    });
+
+    if (out != stdout) {
+        std::fclose(out);
+    } else {
+        std::fflush(out);
+    }
+    if (data) {
+        ::munmap(const_cast<char*>(data), size);
+    }
+
+    if (!ok) {
+        std::fprintf(stderr, "Warning: %s after %zu lines: %s\n", argv[1], lines,
+                     decoder.error().c_str());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,71 @@
+// 分片汇总日志合并工具：把进程崩溃后残留的 ShardedSummarySink 分片按时间顺序合并为汇总日志
+// 用法: log_merge <输出文件> <分片>...，输出文件已存在时追加；合并成功后不会删除分片
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/shard_format.h"
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "Usage: %s <output file> <shard>...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<log_utils::ShardView> shards;
+    for (int i = 2; i < argc; ++i) {
+        int fd = ::open(argv[i], O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::fprintf(stderr, "Error: Cannot open %s: %s\n", argv[i], std::strerror(errno));
+            return 1;
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            std::fprintf(stderr, "Error: Cannot stat %s: %s\n", argv[i], std::strerror(errno));
+            ::close(fd);
+            return 1;
+        }
+        size_t size = static_cast<size_t>(st.st_size);
+        if (size > 0) {
+            void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped == MAP_FAILED) {
+                std::fprintf(stderr, "Error: Cannot map %s: %s\n", argv[i], std::strerror(errno));
+                ::close(fd);
+                return 1;
+            }
+            shards.push_back(log_utils::ShardView{static_cast<const char*>(mapped), size});
+        }
+        ::close(fd);
+    }
+
+    FILE* out = std::fopen(argv[1], "a");
+    if (!out) {
+        std::fprintf(stderr, "Error: Cannot open %s: %s\n", argv[1], std::strerror(errno));
+        return 1;
+    }
+    static char out_buffer[1 << 20];
+    std::setvbuf(out, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    size_t lines = 0;
+    bool complete = log_utils::mergeShards(shards, [&](const char* text, size_t size) {
+        std::fwrite(text, 1, size, out);
+        ++lines;
+    });
+    std::fclose(out);
+    for (const auto& shard : shards) {
+        ::munmap(const_cast<char*>(shard.data), shard.size);
+    }
+
+    if (!complete) {
+        std::fprintf(stderr, "Warning: incomplete record at the end of a shard ignored (%zu lines merged)\n",
+                     lines);
+        return 1;
+    }
+    return 0;
+}
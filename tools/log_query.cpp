@@ -0,0 +1,303 @@
+// 文本日志查询工具：按时间范围、模块和最低级别筛选日志行，有索引（<日志文件>.idx）时只读取可能匹配的块
+// 用法: log_query [-m 模块]... [-l 最低级别] [-f 起始时间] [-t 结束时间] [-v] <日志文件>...
+//   -m  模块名，可重复指定，支持 glob（如 "Planner*"）
+//   -l  DEBUG / INFO / WARN / ERROR，只输出不低于该级别的记录
+//   -f  起始时间（含），-t 结束时间（不含），格式与日志相同，如 "2024-05-01 12:00:00" 或带小数秒
+//   -v  在标准错误输出扫描的块数和字节数
+// 多行消息的后续行随所属记录一起输出。时间按本机时区解释，可通过 TZ 环境变量指定与记录时相同的时区
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "log_utils/log_format.h"
+#include "log_utils/log_index.h"
+
+namespace {
+
+struct Query {
+    std::vector<std::string> modules;
+    std::vector<unsigned> module_bits;  // 全部为精确模块名时用于按块筛选
+    bool module_globs = false;
+    log_utils::LogLevel min_level = log_utils::LogLevel::DEBUG;
+    std::string from;
+    std::string to;
+    int64_t from_us = std::numeric_limits<int64_t>::min();
+    int64_t to_us = std::numeric_limits<int64_t>::max();
+    bool verbose = false;
+};
+
+struct ScanStats {
+    size_t blocks = 0;
+    size_t blocks_read = 0;
+    uint64_t bytes_read = 0;
+    size_t lines = 0;
+};
+
+// 解析 "YYYY-MM-DD HH:MM:SS[.小数]"（本地时间），返回微秒时间戳
+bool parseTime(const std::string& text, int64_t& time_us) {
+    std::tm tm_value;
+    std::memset(&tm_value, 0, sizeof(tm_value));
+    int consumed = 0;
+    if (std::sscanf(text.c_str(), "%4d-%2d-%2d %2d:%2d:%2d%n", &tm_value.tm_year, &tm_value.tm_mon,
+                    &tm_value.tm_mday, &tm_value.tm_hour, &tm_value.tm_min, &tm_value.tm_sec, &consumed) != 6) {
+        return false;
+    }
+    int64_t fraction_us = 0;
+    const char* rest = text.c_str() + consumed;
+    if (*rest == '.') {
+        int64_t scale = 100000;
+        for (++rest; *rest >= '0' && *rest <= '9'; ++rest, scale /= 10) {
+            fraction_us += (*rest - '0') * scale;
+        }
+    }
+    if (*rest != '\0') {
+        return false;
+    }
+    tm_value.tm_year -= 1900;
+    tm_value.tm_mon -= 1;
+    tm_value.tm_isdst = -1;
+    std::time_t seconds = std::mktime(&tm_value);
+    if (seconds == static_cast<std::time_t>(-1)) {
+        return false;
+    }
+    time_us = static_cast<int64_t>(seconds) * 1000000 + fraction_us;
+    return true;
+}
+
+// 块内是否可能有匹配的记录
+bool blockMatches(const Query& query, const log_utils::LogIndexBlock& block) {
+    if (block.max_time_us < query.from_us || block.min_time_us >= query.to_us) {
+        return false;
+    }
+    if ((block.level_mask >> static_cast<int>(query.min_level)) == 0) {
+        return false;
+    }
+    if (query.modules.empty() || query.module_globs) {
+        return true;
+    }
+    for (unsigned bit : query.module_bits) {
+        if (log_utils::logIndexHasModule(block, bit)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 取出 line 中 start 处 "[...]" 的内容，start 移到 "]" 之后
+bool takeBracket(std::string_view line, size_t& start, std::string_view& field) {
+    if (start >= line.size() || line[start] != '[') {
+        return false;
+    }
+    size_t end = line.find(']', start + 1);
+    if (end == std::string_view::npos) {
+        return false;
+    }
+    field = line.substr(start + 1, end - start - 1);
+    start = end + 1;
+    if (start < line.size() && line[start] == ' ') {
+        ++start;
+    }
+    return true;
+}
+
+// 记录的首行形如 "[YYYY-MM-DD ...] [级别] [模块] ..."；返回 false 表示为多行消息的后续行
+bool parseHeader(std::string_view line, std::string_view& timestamp, log_utils::LogLevel& level,
+                 std::string_view& module) {
+    if (line.size() < 12 || line[0] != '[' || line[5] != '-' || line[1] < '0' || line[1] > '9') {
+        return false;
+    }
+    size_t start = 0;
+    std::string_view level_name;
+    if (!takeBracket(line, start, timestamp) || !takeBracket(line, start, level_name) ||
+        !takeBracket(line, start, module)) {
+        return false;
+    }
+    return log_utils::parseLogLevel(std::string(level_name), level);
+}
+
+bool recordMatches(const Query& query, std::string_view timestamp, log_utils::LogLevel level,
+                   std::string_view module) {
+    if (level < query.min_level) {
+        return false;
+    }
+    if (!query.from.empty() && timestamp < query.from) {
+        return false;
+    }
+    if (!query.to.empty() && timestamp >= query.to) {
+        return false;
+    }
+    if (query.modules.empty()) {
+        return true;
+    }
+    if (!query.module_globs) {
+        for (const std::string& name : query.modules) {
+            if (module == name) {
+                return true;
+            }
+        }
+        return false;
+    }
+    std::string name(module);
+    for (const std::string& pattern : query.modules) {
+        if (::fnmatch(pattern.c_str(), name.c_str(), 0) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// 逐行扫描 [begin, end)，区间总是从一条记录的首行开始
+void scanRange(const Query& query, const char* begin, const char* end, FILE* out, ScanStats& stats) {
+    bool matched = false;
+    const char* line = begin;
+    while (line < end) {
+        // glibc 的 memchr 按向量宽度成块比较，是扫描的主要开销所在
+        const char* newline = static_cast<const char*>(std::memchr(line, '\n', end - line));
+        const char* line_end = newline ? newline + 1 : end;
+        std::string_view text(line, static_cast<size_t>(line_end - line));
+        std::string_view timestamp, module;
+        log_utils::LogLevel level;
+        if (parseHeader(text, timestamp, level, module)) {
+            matched = recordMatches(query, timestamp, level, module);
+        }
+        if (matched) {
+            std::fwrite(text.data(), 1, text.size(), out);
+            ++stats.lines;
+        }
+        line = line_end;
+    }
+    stats.bytes_read += static_cast<uint64_t>(end - begin);
+}
+
+bool queryFile(const Query& query, const char* path, FILE* out, ScanStats& stats) {
+    int fd = ::open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        std::fprintf(stderr, "Error: Cannot open %s: %s\n", path, std::strerror(errno));
+        return false;
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        std::fprintf(stderr, "Error: Cannot stat %s: %s\n", path, std::strerror(errno));
+        ::close(fd);
+        return false;
+    }
+    uint64_t size = static_cast<uint64_t>(st.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::fprintf(stderr, "Error: Cannot map %s: %s\n", path, std::strerror(errno));
+        return false;
+    }
+    const char* data = static_cast<const char*>(mapped);
+
+    // 需要扫描的区间：匹配的块，以及没有被任何块覆盖的区间；相邻区间合并后按文件顺序扫描
+    std::vector<std::pair<uint64_t, uint64_t>> ranges;
+    auto addRange = [&](uint64_t begin, uint64_t end) {
+        if (begin == end) {
+            return;
+        }
+        if (!ranges.empty() && ranges.back().second == begin) {
+            ranges.back().second = end;
+        } else {
+            ranges.emplace_back(begin, end);
+        }
+    };
+    std::vector<log_utils::LogIndexBlock> blocks = log_utils::readLogIndex(log_utils::logIndexPath(path), size);
+    uint64_t cursor = 0;
+    for (const log_utils::LogIndexBlock& block : blocks) {
+        addRange(cursor, block.offset);
+        if (blockMatches(query, block)) {
+            addRange(block.offset, block.offset + block.size);
+            ++stats.blocks_read;
+        }
+        cursor = block.offset + block.size;
+    }
+    addRange(cursor, size);
+    stats.blocks += blocks.size();
+
+    for (const auto& range : ranges) {
+        ::madvise(const_cast<char*>(data) + (range.first & ~static_cast<uint64_t>(4095)),
+                  range.second - (range.first & ~static_cast<uint64_t>(4095)), MADV_SEQUENTIAL);
+        scanRange(query, data + range.first, data + range.second, out, stats);
+    }
+    ::munmap(mapped, size);
+    return true;
+}
+
+void usage(const char* program) {
+    std::fprintf(stderr, "Usage: %s [-m module]... [-l min level] [-f from] [-t to] [-v] <log file>...\n", program);
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Query query;
+    int opt;
+    while ((opt = ::getopt(argc, argv, "m:l:f:t:v")) != -1) {
+        switch (opt) {
+            case 'm':
+                query.modules.push_back(optarg);
+                query.module_globs = query.module_globs || std::strpbrk(optarg, "*?[") != nullptr;
+                query.module_bits.push_back(log_utils::logIndexModuleBit(optarg, std::strlen(optarg)));
+                break;
+            case 'l':
+                if (!log_utils::parseLogLevel(optarg, query.min_level)) {
+                    std::fprintf(stderr, "Error: Unknown level: %s\n", optarg);
+                    return 2;
+                }
+                break;
+            case 'f':
+            case 't': {
+                int64_t& bound = opt == 'f' ? query.from_us : query.to_us;
+                if (!parseTime(optarg, bound)) {
+                    std::fprintf(stderr, "Error: Invalid time: %s (expected \"YYYY-MM-DD HH:MM:SS\")\n", optarg);
+                    return 2;
+                }
+                (opt == 'f' ? query.from : query.to) = optarg;
+                break;
+            }
+            case 'v':
+                query.verbose = true;
+                break;
+            default:
+                usage(argv[0]);
+                return 2;
+        }
+    }
+    if (optind >= argc) {
+        usage(argv[0]);
+        return 2;
+    }
+
+    static char out_buffer[1 << 20];
+    std::setvbuf(stdout, out_buffer, _IOFBF, sizeof(out_buffer));
+
+    bool ok = true;
+    for (int i = optind; i < argc; ++i) {
+        ScanStats stats;
+        ok = queryFile(query, argv[i], stdout, stats) && ok;
+        if (query.verbose) {
+            std::fprintf(stderr, "%s: %zu/%zu blocks, %llu bytes scanned, %zu lines\n", argv[i],
+                         stats.blocks_read, stats.blocks, static_cast<unsigned long long>(stats.bytes_read),
+                         stats.lines);
+        }
+    }
+    std::fflush(stdout);
+    return ok ? 0 : 1;
+}